@@ -25,6 +25,7 @@
 
 class OSSEnable;
 class ALSADevice;
+class ALSAStats;
 
 #include "guicast.h"
 #include "playbackconfig.inc"
@@ -94,6 +95,9 @@ private:
 	ALSADevice *alsa_device;
 	SampleBitsSelection *alsa_bits;
 	BC_CheckBox *alsa_workaround;
+	BC_CheckBox *alsa_mmap;
+	BC_CheckBox *alsa_adaptive;
+	ALSAStats *alsa_stats;
 	ArrayList<BC_ListBoxItem*> *alsa_drivers;
 };
 
@@ -152,6 +156,21 @@ public:
 	int *output;
 };
 
+// Milliseconds between updates of the playback statistics
+#define ALSA_STATS_REPEAT 1000
+
+class ALSAStats : public BC_Title
+{
+public:
+	ALSAStats(int x, int y);
+	~ALSAStats();
+
+	void create_objects();
+	int repeat_event(int64_t duration);
+	int latency;
+	int xruns;
+};
+
 class ALSADevice : public BC_PopupTextBox
 {
 public:
@@ -47,6 +47,12 @@ public:
 	int flush_device();
 	int interrupt_playback();
 
+// Statistics from the most recent playback for the preferences window
+// Underruns since the output was opened
+	static int xruns;
+// Frames queued in the device when the last buffer was written, in ms
+	static int latency;
+
 private:
 	int close_output();
 	void translate_name(char *output, char *input);
@@ -56,6 +62,7 @@ private:
 		int bits,
 		int samplerate,
 		int samples);
+	int write_mmap(char *buffer, int samples);
 	int create_format(snd_pcm_format_t *format, int bits, int channels, int rate);
 	snd_pcm_t* get_output();
 	snd_pcm_t* get_input();
@@ -65,6 +72,10 @@ private:
 	int delay;
 	Mutex *timer_lock;
 	int interrupted;
+// Output is using SND_PCM_ACCESS_MMAP_INTERLEAVED
+	int use_mmap;
+// Power of 2 the device buffer is divided by in adaptive mode
+	int adaptive_shift;
 };
 
 #endif
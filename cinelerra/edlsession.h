@@ -77,6 +77,8 @@ public:
 	int asset_columns[ASSET_COLUMNS];
 	AutoConf *auto_conf;
 	float actual_frame_rate;
+// Milliseconds the video driver took to show a frame
+	float actual_present_latency;
 // Aspect ratio for video
 	double aspect_w;
 	double aspect_h;
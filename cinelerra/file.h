@@ -103,6 +103,8 @@ public:
 		int ring_buffers, 
 		int compressed);
 	int stop_video_thread();
+// Wait for the video thread to write all the frames passed to it
+	int wait_video_thread();
 
 	void start_video_decode_thread();
 
@@ -34,12 +34,19 @@ extern "C"
 
 
 // Mpeg2enc prototypes
-void mpeg2enc_init_buffers();
-int mpeg2enc(int argc, char *argv[]);
-void mpeg2enc_set_w(int width);
-void mpeg2enc_set_h(int height);
-void mpeg2enc_set_rate(double rate);
-void mpeg2enc_set_input_buffers(int eof, char *y, char *u, char *v);
+typedef struct mpeg2enc_s mpeg2enc_t;
+mpeg2enc_t* mpeg2enc_new();
+void mpeg2enc_delete(mpeg2enc_t *encoder);
+void mpeg2enc_init_buffers(mpeg2enc_t *encoder);
+int mpeg2enc(mpeg2enc_t *encoder, int argc, char *argv[]);
+void mpeg2enc_set_w(mpeg2enc_t *encoder, int width);
+void mpeg2enc_set_h(mpeg2enc_t *encoder, int height);
+void mpeg2enc_set_rate(mpeg2enc_t *encoder, double rate);
+int mpeg2enc_set_input_buffers(mpeg2enc_t *encoder, 
+	int eof, 
+	char *y, 
+	char *u, 
+	char *v);
 
 
 
@@ -175,6 +182,8 @@ public:
 	void run();
 
 	FileMPEG *file;
+// State of the mpeg2enc instance for this file
+	mpeg2enc_t *encoder;
 };
 
 class FileMPEGAudio : public Thread
@@ -70,6 +70,9 @@ public:
 			int ring_buffers, 
 			int compressed);
 	int stop_writing();
+// Wait for every buffer passed to write_buffer to be written without
+// stopping the loop.
+	int wait_writing();
 
 
 
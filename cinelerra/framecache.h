@@ -30,6 +30,11 @@
 
 #include <stdint.h>
 
+// Buckets in the table of frames with deduplicated image data
+#define FRAMECACHE_BUCKETS 256
+// Words of a frame hashed to look for a duplicate
+#define FRAMECACHE_HASH_SAMPLES 1024
+
 // Simply a table of images described by frame position and dimensions.
 // The frame position is relative to the frame rate of the source file.
 // This object is used by File for playback.
@@ -44,10 +49,21 @@ public:
 	~FrameCacheItem();
 
 	int get_size();
+// Give the image data to the first sharer and repoint the other sharers
+// at it.  Data is 0 afterwards.
+	void hand_down();
 
 	VFrame *data;
 	double frame_rate;
 	int layer;
+// Hash of the image data if deduplicating
+	uint64_t hash;
+// Item whose image data this item shares or 0 if the data is private.
+	FrameCacheItem *source;
+// Number of items sharing the image data of this item.
+	int sharers;
+// Next item in the same hash bucket of the cache
+	FrameCacheItem *next_hash;
 };
 
 class FrameCache : public CacheBase
@@ -66,6 +82,7 @@ public:
 // If a frame is found, the frame cache is left in the locked state until 
 // unlock is called.  If nothing is found, the frame cache is unlocked before
 // returning.  This keeps the item from being deleted.
+// The frame may share its image data with other items so it's read only.
 // asset - supplied by user if the cache is not part of a file.
 	VFrame* get_frame_ptr(int64_t position,
 		int layer,
@@ -87,12 +104,21 @@ public:
 
 	void dump();
 
+// Share the image data of identical frames instead of storing copies.
+	int dedup;
+
+// Index items owning image data by hash.  Called by FrameCacheItem.
+	void add_hash(FrameCacheItem *item);
+	void remove_hash(FrameCacheItem *item);
+
 
 
 
 
 
 private:
+// Return the item owning image data identical to frame or 0.
+	FrameCacheItem* find_duplicate(VFrame *frame, uint64_t hash);
 // Return 1 if matching frame exists.
 // Return 0 if not.
 	int frame_exists(VFrame *format,
@@ -109,6 +135,8 @@ private:
 		int h,
 		FrameCacheItem **item_return,
 		int asset_id);
+
+	FrameCacheItem *hash_table[FRAMECACHE_BUCKETS];
 };
 
 
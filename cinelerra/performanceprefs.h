@@ -118,6 +118,42 @@ public:
 	PreferencesWindow *pwindow;
 };
 
+class PrefsDedupFrames : public BC_CheckBox
+{
+public:
+	PrefsDedupFrames(PreferencesWindow *pwindow, int x, int y);
+	~PrefsDedupFrames();
+	
+	int handle_event();
+	
+	
+	PreferencesWindow *pwindow;
+};
+
+
+
+
+class PrefsResampleQuality : public BC_PopupMenu
+{
+public:
+	PrefsResampleQuality(PreferencesWindow *pwindow, int x, int y);
+
+	void create_objects();
+	int handle_event();
+	static const char* quality_to_text(int quality);
+
+	PreferencesWindow *pwindow;
+};
+
+class PrefsResampleQualityItem : public BC_MenuItem
+{
+public:
+	PrefsResampleQualityItem(PrefsResampleQuality *popup, int quality);
+	int handle_event();
+
+	PrefsResampleQuality *popup;
+	int quality;
+};
 
 
 
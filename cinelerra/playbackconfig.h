@@ -63,6 +63,10 @@ public:
 	char alsa_out_device[BCTEXTLEN];
 	int alsa_out_bits;
 	int interrupt_workaround;
+// Write directly into the device ring with snd_pcm_mmap_begin/commit
+	int alsa_out_mmap;
+// Start with a short device buffer and grow it whenever an xrun occurs
+	int alsa_out_adaptive;
 
 // Firewire options
 	int firewire_channel;
@@ -74,6 +74,7 @@ public:
 
 	PlaybackConfig *playback_config;
 	BC_Title *framerate_title;
+	BC_Title *latency_title;
 	PlaybackNearest *nearest_neighbor;
 	PlaybackLanczosLanczos *lanczos_lanczos;
 	PlaybackBicubicBicubic *cubic_cubic;
@@ -361,6 +361,9 @@ public:
 
 // Get the direction of the most recent process_buffer
 	int get_direction();
+// Return 1 if the most recent process_buffer was for a render to a file
+// instead of playback
+	int get_rendering();
 
 // Plugin must call this before performing OpenGL operations.
 // Returns 1 if the user supports opengl buffers.
@@ -488,6 +491,8 @@ public:
 
 // Direction of most recent process_buffer
 	int direction;
+// Most recent process_buffer was for a render
+	int rendering;
 
 // Operating system scheduling
 	int realtime_priority;
@@ -175,11 +175,14 @@ public:
 // total_len - length of plugin in track units relative to the EDL rate
 // Units are kept relative to the EDL rate so plugins don't need to convert rates
 // to get the keyframes.
-	void process_buffer(VFrame **frame, 
+// rendering - 1 if rendering to a file instead of playing back
+// Return 1 if the user cancelled the effect.
+	int process_buffer(VFrame **frame, 
 		int64_t current_position,
 		double frame_rate,
 		int64_t total_len,
-		int direction);
+		int direction,
+		int rendering);
 	void process_buffer(double **buffer,
 		int64_t current_position,
 		int64_t fragment_size,
@@ -32,6 +32,10 @@
 #define PLUGIN_MAX_W 2000
 #define PLUGIN_MAX_H 1000
 
+// Returned by process_buffer when the user cancelled a slow effect.  Stops
+// the render.  Other return values are ignored.
+#define PLUGIN_CANCELLED -1
+
 
 
 class PluginVClient : public PluginClient
@@ -86,6 +86,10 @@ public:
 	double render_preroll;
 	int brender_preroll;
 	int force_uniprocessor;
+// Share identical frames in the frame cache.
+	int dedup_frames;
+// Quality preset for sample rate conversion from resample.inc
+	int resample_quality;
 // The number of cpus to use when rendering.
 // Determined by /proc/cpuinfo and force_uniprocessor
 	int processors;
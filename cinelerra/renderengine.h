@@ -94,7 +94,7 @@ public:
 	int64_t session_position();
 
 // Update preferences window
-	void update_framerate(float framerate);
+	void update_framerate(float framerate, float present_latency);
 
 // Copy of command
 	TransportCommand *command;
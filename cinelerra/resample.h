@@ -23,9 +23,11 @@
 #define RESAMPLE_H
 
 #define BPC 160
-#define BLACKSIZE 25
+// History kept between chunks.  Must be longer than the longest filter.
+#define BLACKSIZE 53
 
 #include "file.inc"
+#include "resample.inc"
 
 class Resample
 {
@@ -35,6 +37,8 @@ public:
 
 // Reset after seeking
 	void reset(int channel = -1);
+// Change the quality preset.  Resets if it changed.
+	void set_quality(int quality);
 	double blackman(int i, double offset, double fcn, int l);
 // Query output temp
 	int get_output_size(int channel);
@@ -87,7 +91,13 @@ public:
 	int *resample_init;
 // Last sample ratio configured to
 	double last_ratio;
+// Sample ratio the blackman filter table was computed for.
+// The table is shared by all channels and survives seeks.
+	double blackfilt_ratio;
+	int blackfilt_quality;
 	double blackfilt[2 * BPC + 1][BLACKSIZE];
+// RESAMPLE_FAST, RESAMPLE_NORMAL, or RESAMPLE_BEST
+	int quality;
 	File *file;
 // Determine whether to reset after a seek
 // Sample end of last buffer read for each channel
@@ -102,6 +112,8 @@ public:
 
 // Reset after seeking
 	void reset(int channel = -1);
+// Change the quality preset.  Resets if it changed.
+	void set_quality(int quality);
 	float blackman(int i, float offset, float fcn, int l);
 // Query output temp
 	int get_output_size(int channel);
@@ -154,7 +166,13 @@ public:
 	int *resample_init;
 // Last sample ratio configured to
 	float last_ratio;
+// Sample ratio the blackman filter table was computed for.
+// The table is shared by all channels and survives seeks.
+	float blackfilt_ratio;
+	int blackfilt_quality;
 	float blackfilt[2 * BPC + 1][BLACKSIZE];
+// RESAMPLE_FAST, RESAMPLE_NORMAL, or RESAMPLE_BEST
+	int quality;
 	File *file;
 // Determine whether to reset after a seek
 // Sample end of last buffer read for each channel
@@ -34,7 +34,8 @@ public:
 	
 	void delete_buffer_vector();
 	void new_buffer_vector(int width, int height, int colormodel);
-	void render(VFrame *output, 
+// Return 1 if the user cancelled the plugin
+	int render(VFrame *output, 
 		int buffer_number,
 		int64_t start_position,
 		double frame_rate,
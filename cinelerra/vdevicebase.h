@@ -40,7 +40,10 @@ public:
 	virtual int close_all() { return 1; };
 	virtual int has_signal() { return 0; };
 	virtual int read_buffer(VFrame *frame) { return 1; };
+	virtual int borrow_buffer(VFrame *frame, int frames_held) { return read_buffer(frame); };
+	virtual void release_buffers() {};
 	virtual int write_buffer(VFrame *output, EDL *edl) { return 1; };
+	virtual float get_present_latency() { return -1; };
 	virtual void new_output_buffer(VFrame **output, int colormodel) {};
 	virtual ArrayList<int>* get_render_strategies() { return 0; };
 	virtual int get_shared_data(unsigned char *data, long size) { return 0; };
@@ -28,6 +28,7 @@
 #endif
 #ifdef HAVE_VIDEO4LINUX2
 
+#include "arraylist.h"
 #include "vdevicebase.h"
 #include <linux/types.h>
 #include <linux/videodev2.h>
@@ -56,6 +57,10 @@ public:
 	void run();
 	VFrame* get_buffer(int *timed_out);
 	void put_buffer();
+// Take the current buffer without requeueing it.  Returns the buffer number
+// to pass to release_buffer when the caller is done with it.
+	int borrow_buffer();
+	void release_buffer(int number);
 	void allocate_buffers(int number);
 
 	Mutex *buffer_lock;
@@ -66,6 +71,13 @@ public:
 	VFrame **device_buffers;
 	int *buffer_valid;
 	int total_valid;
+// Numbers of the valid buffers in the order they were dequeued.  Borrowed
+// buffers come back out of order so the ring can't follow the buffer numbers.
+	int *buffer_queue;
+	int queue_start;
+// Buffers taken by borrow_buffer.  These aren't unmapped by the destructor.
+	int *buffer_borrowed;
+	int total_borrowed;
 	int total_buffers;
 	int current_inbuffer;
 	int current_outbuffer;
@@ -112,12 +124,27 @@ public:
 	int initialize();
 	int get_best_colormodel(Asset *asset);
 	int read_buffer(VFrame *frame);
+	int borrow_buffer(VFrame *frame, int frames_held);
+	void release_buffers();
 	int has_signal();
 	static int cmodel_to_device(int color_model);
 	static int get_sources(VideoDevice *device,
 		char *path);
 
 	VDeviceV4L2Thread *thread;
+
+private:
+	int grab_buffer(VFrame *frame, int frames_held);
+	int release_frame(VFrame *frame);
+	void delete_thread();
+
+// Frames pointing to capture buffers and the buffer number each one holds
+	ArrayList<VFrame*> borrowed_frames;
+	ArrayList<int> borrowed_buffers;
+// Mappings of borrowed buffers whose capture thread was deleted
+	ArrayList<VFrame*> retired_frames;
+	ArrayList<unsigned char*> retired_data;
+	ArrayList<long> retired_size;
 };
 
 #endif
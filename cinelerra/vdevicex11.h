@@ -22,7 +22,9 @@
 #ifndef VDEVICEX11_H
 #define VDEVICEX11_H
 
+#include "bctimer.h"
 #include "canvas.inc"
+#include "condition.inc"
 #include "edl.inc"
 #include "guicast.h"
 #include "maskauto.inc"
@@ -30,12 +32,37 @@
 #include "pluginclient.inc"
 #include "thread.h"
 #include "vdevicebase.h"
+#include "vdevicex11.inc"
 
 // output_frame is the same one written to device
 #define BITMAP_PRIMARY 0
 // output_frame is a temporary converted to the device format
 #define BITMAP_TEMP    1
 
+// Puts bitmaps on the screen so the renderer doesn't wait for the X server.
+class X11PresentThread : public Thread
+{
+public:
+	X11PresentThread(VDeviceX11 *device);
+	~X11PresentThread();
+
+	void run();
+// Show the current ring buffer of the bitmap.  output_lock must be held.
+	void present();
+	void stop();
+
+	VDeviceX11 *device;
+// Frame ready to present
+	Condition *input_lock;
+// Held from present until the X server has finished reading the bitmap
+	Condition *output_lock;
+	Timer timer;
+// Microseconds from present until the X server finished the last frame
+	int64_t latency;
+	int have_latency;
+	int done;
+};
+
 class VDeviceX11 : public VDeviceBase
 {
 public:
@@ -55,6 +82,11 @@ public:
 	int output_visible();
 // After loading the bitmap with a picture, write it
 	int write_buffer(VFrame *result, EDL *edl);
+// Average milliseconds from write_buffer until the X server finished
+// showing the frame, since the last call.  -1 if nothing was presented.
+	float get_present_latency();
+// Called by X11PresentThread
+	void present_frame();
 // Get best colormodel for recording
 	int get_best_colormodel(Asset *asset);
 
@@ -130,6 +162,13 @@ private:
 // For OpenGL, it creates the array of row pointers used to upload the video
 // frame to the texture, the texture, and the PBuffer.
 	int get_best_colormodel(int colormodel);
+// Put the bitmap on the canvas.  The canvas must be locked.
+	void draw_output(int dont_wait);
+// Wait for the present thread to release the bitmap.
+// The canvas must not be locked.
+	void wait_present();
+// Accumulate the latency of the last frame presented.  output_lock must be held.
+	void collect_latency();
 
 // Bitmap to be written to device
 	BC_Bitmap *bitmap;        
@@ -159,6 +198,10 @@ private:
 	BC_Capture *capture_bitmap;
 // Set when OpenGL rendering has cleared the frame buffer before write_buffer
 	int is_cleared;
+// Presents bitmaps during playback
+	X11PresentThread *present_thread;
+	int64_t present_total;
+	int present_frames;
 };
 
 #endif
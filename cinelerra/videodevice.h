@@ -145,6 +145,15 @@ public:
 	int set_picture(PictureConfig *picture);
 	int capture_frame(int frame_number);  // Start the frame_number capturing
 	int read_buffer(VFrame *frame);  // Read the next frame off the device
+// Like read_buffer but the frame may point to the capture buffer instead
+// of a copy.  The capture buffer is given back to the driver the next
+// time the same frame is passed in or when release_buffers is called, so
+// the caller must be done with every frame it borrowed by then.
+// frames_held - the most frames the caller keeps before passing them in
+// again.  If that would leave the driver too few buffers the frame is
+// copied instead.
+	int borrow_buffer(VFrame *frame, int frames_held);
+	void release_buffers();
 	int has_signal();
 	int frame_to_vframe(VFrame *frame, unsigned char *input); // Translate the captured frame to a VFrame
 	void initialize();
@@ -179,6 +188,8 @@ public:
 // absolute frame of last frame in buffer.
 // The EDL parameter is passed to Canvas and can be 0.
 	int write_buffer(VFrame *output, EDL *edl);   
+// Average milliseconds to show a frame since the last call or -1
+	float get_present_latency();
 
 
 
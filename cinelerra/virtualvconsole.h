@@ -58,6 +58,8 @@ public:
 
 	VFrame *output_temp;
 	VRender *vrender;
+// A plugin was cancelled while compositing the current frame
+	int plugin_cancelled;
 // Calculated at the start of every process_buffer
 	int use_opengl;
 };
@@ -66,7 +66,8 @@ public:
 
 // When showing the same frame twice need to rewind
 	void rewind_ring();
-// If dont_wait is true, the XSync comes before the flash.
+// If dont_wait is true, the X server is only waited for when the next ring
+// buffer may still be in use by an earlier put.
 // For YUV bitmaps, the image is scaled to fill dest_x ... w * dest_y ... h
 	int write_drawable(Drawable &pixmap, 
 		GC &gc,
@@ -130,6 +131,8 @@ private:
 	char byte_bitswap(char src);
 
 	int ring_buffers, current_ringbuffer;
+// Request serial of the last put from each ring buffer
+	unsigned long ring_serial[BITMAP_RING];
 	int w, h;
 // Color model from bccmodels.h
 	int color_model;
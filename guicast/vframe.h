@@ -30,6 +30,8 @@
 #include "bccmodels.h"
 #include "vframe.inc"
 
+#include <stdint.h>
+
 class PngReadFunction;
 
 
@@ -97,6 +99,12 @@ public:
 
 // if frame points to the same data as this return 1
 	int equals(VFrame *frame);
+// Hash of the image data.  Used to find identical frames.
+// samples - number of 8 byte words spread over the frame to hash or 0 to
+// hash all of it.
+	uint64_t get_hash(int samples = 0);
+// if frame has the same format and image data as this return 1
+	int same_contents(VFrame *frame);
 // Test if frame already matches parameters
 	int params_match(int w, int h, int color_model);
 
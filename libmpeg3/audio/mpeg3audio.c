@@ -215,12 +215,6 @@ static int read_frame(mpeg3audio_t *audio, int render)
 	int i;
 	int old_channels = track->channels;
 
-// Liba52 is not reentrant
-	if(track->format == AUDIO_AC3)
-	{
-		pthread_mutex_lock(decode_lock);
-	}
-
 /* Find and read next header */
 	result = read_header(audio);
 
@@ -268,11 +262,15 @@ static int read_frame(mpeg3audio_t *audio, int render)
 		switch(track->format)
 		{
 			case AUDIO_AC3:
+// Liba52 is not reentrant.  Only the decoding is locked so the other
+// tracks can read and parse headers meanwhile.
+				pthread_mutex_lock(decode_lock);
 				samples = mpeg3audio_doac3(audio->ac3_decoder, 
 					audio->packet_buffer,
 					audio->framesize,
 					temp_output,
 					render);
+				pthread_mutex_unlock(decode_lock);
 //printf("read_frame %d\n", samples);
 				break;
 
@@ -319,12 +317,6 @@ static int read_frame(mpeg3audio_t *audio, int render)
 		free(temp_output);
 	}
 
-// Liba52 is not reentrant
-	if(track->format == AUDIO_AC3)
-	{
-		pthread_mutex_unlock(decode_lock);
-	}
-
 
 // Shift demuxer data
 	if(!file->seekable) 
@@ -470,7 +462,10 @@ mpeg3audio_t* mpeg3audio_new(mpeg3_t *file,
 		switch(track->format)
 		{
 			case AUDIO_AC3:
+// a52_init fills tables the decoding reads
+				pthread_mutex_lock(decode_lock);
 				audio->ac3_decoder = mpeg3_new_ac3();
+				pthread_mutex_unlock(decode_lock);
 				break;
 			case AUDIO_MPEG:
 				audio->layer_decoder = mpeg3_new_layer();
@@ -816,7 +811,11 @@ int mpeg3audio_decode_audio(mpeg3audio_t *audio,
 		if(calculate_format(file, track)) return 1;
 
 	if(track->format == AUDIO_AC3 && !audio->ac3_decoder)
+	{
+		pthread_mutex_lock(decode_lock);
 		audio->ac3_decoder = mpeg3_new_ac3();
+		pthread_mutex_unlock(decode_lock);
+	}
 	else
 	if(track->format == AUDIO_MPEG && !audio->layer_decoder)
 		audio->layer_decoder = mpeg3_new_layer();
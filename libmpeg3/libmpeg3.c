@@ -564,6 +564,14 @@ int mpeg3_set_cpus(mpeg3_t *file, int cpus)
 	return 0;
 }
 
+int mpeg3_set_mmx(mpeg3_t *file, int use_mmx)
+{
+	int i;
+	for(i = 0; i < file->total_vstreams; i++)
+		mpeg3video_set_mmx(file->vtrack[i]->video, use_mmx);
+	return 0;
+}
+
 int mpeg3_has_audio(mpeg3_t *file)
 {
 	return file->total_astreams > 0;
@@ -1043,6 +1051,8 @@ int64_t mpeg3_memory_usage(mpeg3_t *file)
 	for(i = 0; i < file->total_vstreams; i++)
 	{
 		result += mpeg3_cache_usage(file->vtrack[i]->frame_cache);
+		if(file->vtrack[i]->gop)
+			result += mpeg3_gop_usage(file->vtrack[i]->gop);
 	}
 	return result;
 }
@@ -59,6 +59,8 @@ int mpeg3_close(mpeg3_t *file);
 
 /* Performance */
 int mpeg3_set_cpus(mpeg3_t *file, int cpus);
+/* Use SSE2 for video if the CPU has it.  On by default. */
+int mpeg3_set_mmx(mpeg3_t *file, int use_mmx);
 
 /* Query the MPEG3 stream about audio. */
 int mpeg3_has_audio(mpeg3_t *file);
@@ -0,0 +1,393 @@
+#include "libmpeg3.h"
+#include "mpeg3protos.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Decode the GOPs following the current frame on separate copies of the file.
+// Only used with a table of contents when more than 1 cpu is set and the
+// frames are read in order.  Each worker seeks to the first frame of its GOP
+// the same way a random access read would, so the frames are the same as
+// the ones the main decoder would return.
+// The copies only contain the one video track and borrow its table of
+// contents from the main file.
+
+
+static void decode_gop(mpeg3_gop_worker_t *worker)
+{
+	mpeg3_gop_t *gop = worker->gop;
+	mpeg3_t *file = worker->file;
+	int64_t frame;
+
+	mpeg3_set_frame(file, worker->start_frame, 0);
+	for(frame = worker->start_frame; frame < worker->end_frame; frame++)
+	{
+		char *y = 0, *u = 0, *v = 0;
+		int number = frame - worker->start_frame;
+
+		if(worker->cancel) break;
+
+/* The main decoder takes over from here */
+		if(number >= worker->frames_allocated ||
+			mpeg3_read_yuvframe_ptr(file, &y, &u, &v, 0) ||
+			!y || !u || !v)
+			break;
+
+		memcpy(worker->y[number], y, gop->y_size);
+		memcpy(worker->u[number], u, gop->u_size);
+		memcpy(worker->v[number], v, gop->v_size);
+
+		pthread_mutex_lock(&worker->state_lock);
+		worker->total_frames++;
+		pthread_cond_broadcast(&worker->state_cond);
+		pthread_mutex_unlock(&worker->state_lock);
+	}
+}
+
+static void* gop_worker_loop(void *ptr)
+{
+	mpeg3_gop_worker_t *worker = ptr;
+
+	while(!worker->done)
+	{
+		pthread_mutex_lock(&worker->input_lock);
+
+		if(!worker->done)
+		{
+			decode_gop(worker);
+		}
+
+		pthread_mutex_lock(&worker->state_lock);
+		worker->busy = 0;
+		pthread_cond_broadcast(&worker->state_cond);
+		pthread_mutex_unlock(&worker->state_lock);
+	}
+	return 0;
+}
+
+/* Open the track on a new file without reading the table of contents again */
+static mpeg3_t* open_track(mpeg3_t *file, mpeg3_vtrack_t *track)
+{
+	mpeg3_t *copy = mpeg3_new(file->fs->path);
+	int64_t *frame_offsets = track->frame_offsets;
+	int64_t *keyframe_numbers = track->keyframe_numbers;
+	int total_frame_offsets = track->total_frame_offsets;
+	int total_keyframe_numbers = track->total_keyframe_numbers;
+	int64_t video_eof = track->demuxer->stream_end;
+
+/* Everything mpeg3_get_file_type would have set */
+	copy->is_transport_stream = file->is_transport_stream;
+	copy->is_program_stream = file->is_program_stream;
+	copy->is_ifo_file = file->is_ifo_file;
+	copy->is_audio_stream = file->is_audio_stream;
+	copy->is_video_stream = file->is_video_stream;
+	copy->is_bd = file->is_bd;
+	copy->packet_size = file->packet_size;
+	copy->seekable = file->seekable;
+	copy->program = file->program;
+	copy->source_date = file->source_date;
+	mpeg3demux_copy_titles(copy->demuxer, file->demuxer);
+
+/* Lend the tables to mpeg3_new_vtrack.  The track doesn't own them. */
+	copy->frame_offsets = &frame_offsets;
+	copy->keyframe_numbers = &keyframe_numbers;
+	copy->total_frame_offsets = &total_frame_offsets;
+	copy->total_keyframe_numbers = &total_keyframe_numbers;
+	copy->video_eof = &video_eof;
+	copy->vtrack[0] = mpeg3_new_vtrack(copy, track->pid, copy->demuxer, 0);
+	copy->frame_offsets = 0;
+	copy->keyframe_numbers = 0;
+	copy->total_frame_offsets = 0;
+	copy->total_keyframe_numbers = 0;
+	copy->video_eof = 0;
+
+	if(!copy->vtrack[0])
+	{
+		mpeg3_delete(copy);
+		return 0;
+	}
+	copy->total_vstreams = 1;
+	return copy;
+}
+
+static mpeg3_gop_worker_t* new_worker(mpeg3_gop_t *gop, mpeg3_t *file)
+{
+	mpeg3_gop_worker_t *worker;
+	pthread_attr_t attr;
+	pthread_mutexattr_t mutex_attr;
+	mpeg3_t *copy = open_track(file, gop->track);
+
+	if(!copy) return 0;
+
+	worker = calloc(1, sizeof(mpeg3_gop_worker_t));
+	worker->gop = gop;
+	worker->file = copy;
+	worker->gop_number = -1;
+
+	pthread_attr_init(&attr);
+	pthread_mutexattr_init(&mutex_attr);
+	pthread_mutex_init(&worker->input_lock, &mutex_attr);
+	pthread_mutex_lock(&worker->input_lock);
+	pthread_mutex_init(&worker->state_lock, &mutex_attr);
+	pthread_cond_init(&worker->state_cond, 0);
+	pthread_create(&worker->tid, &attr, gop_worker_loop, worker);
+	return worker;
+}
+
+static void wait_idle(mpeg3_gop_worker_t *worker)
+{
+	pthread_mutex_lock(&worker->state_lock);
+	while(worker->busy)
+		pthread_cond_wait(&worker->state_cond, &worker->state_lock);
+	pthread_mutex_unlock(&worker->state_lock);
+}
+
+static void delete_worker(mpeg3_gop_worker_t *worker)
+{
+	int i;
+
+	worker->cancel = 1;
+	wait_idle(worker);
+	worker->done = 1;
+	worker->busy = 1;
+	pthread_mutex_unlock(&worker->input_lock);
+	pthread_join(worker->tid, 0);
+
+	pthread_mutex_destroy(&worker->input_lock);
+	pthread_mutex_destroy(&worker->state_lock);
+	pthread_cond_destroy(&worker->state_cond);
+	mpeg3_close(worker->file);
+
+	for(i = 0; i < worker->frames_allocated; i++)
+	{
+		free(worker->y[i]);
+		free(worker->u[i]);
+		free(worker->v[i]);
+	}
+	if(worker->y) free(worker->y);
+	if(worker->u) free(worker->u);
+	if(worker->v) free(worker->v);
+	free(worker);
+}
+
+static void start_worker(mpeg3_gop_t *gop,
+	mpeg3_gop_worker_t *worker,
+	int gop_number,
+	int64_t start_frame,
+	int64_t end_frame)
+{
+	worker->cancel = 1;
+	wait_idle(worker);
+
+	worker->gop_number = gop_number;
+	worker->start_frame = start_frame;
+	worker->end_frame = end_frame;
+	worker->total_frames = 0;
+
+/* Allocate the frames before the worker starts so it never resizes the */
+/* tables being read by mpeg3_gop_get_frame. */
+	if(end_frame - start_frame > worker->frames_allocated &&
+		worker->frames_allocated < gop->max_frames)
+	{
+		int i;
+		int new_allocation = MIN(end_frame - start_frame, gop->max_frames);
+		unsigned char **y = malloc(sizeof(unsigned char*) * new_allocation);
+		unsigned char **u = malloc(sizeof(unsigned char*) * new_allocation);
+		unsigned char **v = malloc(sizeof(unsigned char*) * new_allocation);
+		for(i = 0; i < new_allocation; i++)
+		{
+			if(i < worker->frames_allocated)
+			{
+				y[i] = worker->y[i];
+				u[i] = worker->u[i];
+				v[i] = worker->v[i];
+			}
+			else
+			{
+				y[i] = malloc(gop->y_size);
+				u[i] = malloc(gop->u_size);
+				v[i] = malloc(gop->v_size);
+			}
+		}
+
+		pthread_mutex_lock(&worker->state_lock);
+		if(worker->y) free(worker->y);
+		if(worker->u) free(worker->u);
+		if(worker->v) free(worker->v);
+		worker->y = y;
+		worker->u = u;
+		worker->v = v;
+		worker->frames_allocated = new_allocation;
+		pthread_mutex_unlock(&worker->state_lock);
+	}
+
+	worker->cancel = 0;
+	worker->busy = 1;
+	pthread_mutex_unlock(&worker->input_lock);
+}
+
+/* Frame range of a GOP from the keyframe table */
+static void gop_range(mpeg3_vtrack_t *track,
+	int gop_number,
+	int64_t *start_frame,
+	int64_t *end_frame)
+{
+	*start_frame = gop_number ? track->keyframe_numbers[gop_number] : 0;
+	if(gop_number < track->total_keyframe_numbers - 1)
+		*end_frame = track->keyframe_numbers[gop_number + 1];
+	else
+		*end_frame = track->total_frames;
+}
+
+/* GOP containing the frame */
+static int frame_to_gop(mpeg3_vtrack_t *track, int64_t frame_number)
+{
+	int min = 0;
+	int max = track->total_keyframe_numbers - 1;
+
+	while(min < max)
+	{
+		int middle = (min + max + 1) / 2;
+		if(track->keyframe_numbers[middle] <= frame_number)
+			min = middle;
+		else
+			max = middle - 1;
+	}
+	return min;
+}
+
+static mpeg3_gop_worker_t* get_worker(mpeg3_gop_t *gop, int gop_number)
+{
+	int i;
+	for(i = 0; i < gop->total_workers; i++)
+		if(gop->workers[i]->gop_number == gop_number)
+			return gop->workers[i];
+	return 0;
+}
+
+mpeg3_gop_t* mpeg3_new_gop(mpeg3_t *file, mpeg3_vtrack_t *track)
+{
+	mpeg3_gop_t *gop = calloc(1, sizeof(mpeg3_gop_t));
+	mpeg3video_t *video = track->video;
+	int i;
+
+	gop->track = track;
+	gop->next_frame = -1;
+	for(i = 0; i < file->total_vstreams; i++)
+		if(file->vtrack[i] == track) gop->stream = i;
+
+	gop->y_size = video->coded_picture_width * video->coded_picture_height;
+	gop->u_size = gop->v_size = video->chrom_width * video->chrom_height;
+	gop->max_frames = MAX(MPEG3_GOP_BYTES / 
+		(gop->y_size + gop->u_size + gop->v_size), 1);
+	return gop;
+}
+
+void mpeg3_delete_gop(mpeg3_gop_t *gop)
+{
+	int i;
+	for(i = 0; i < gop->total_workers; i++)
+		delete_worker(gop->workers[i]);
+	free(gop);
+}
+
+int mpeg3_gop_get_frame(mpeg3video_t *video,
+	int64_t frame_number,
+	unsigned char **y,
+	unsigned char **u,
+	unsigned char **v)
+{
+	mpeg3_t *file = video->file;
+	mpeg3_vtrack_t *track = video->track;
+	mpeg3_gop_t *gop = track->gop;
+	mpeg3_gop_worker_t *worker;
+	int64_t start_frame, end_frame;
+	int gop_number, total_gops, i, j;
+	int sequential;
+	int result = 0;
+
+	if(file->cpus < 2 ||
+		!file->seekable ||
+		track->total_keyframe_numbers < 2 ||
+		frame_number < 0 ||
+		frame_number >= track->total_frames)
+		return 0;
+
+	if(!gop) gop = track->gop = mpeg3_new_gop(file, track);
+	sequential = (frame_number == gop->next_frame);
+	gop->next_frame = frame_number + 1;
+
+	total_gops = track->total_keyframe_numbers;
+	gop_number = frame_to_gop(track, frame_number);
+	worker = get_worker(gop, gop_number);
+
+/* Let the main decoder handle random access */
+	if(!worker && !sequential) return 0;
+
+/* Start the workers on the first time through */
+	while(gop->total_workers < file->cpus &&
+		gop->total_workers < MPEG3_MAX_CPUS)
+	{
+		mpeg3_gop_worker_t *new_one = new_worker(gop, file);
+		if(!new_one) break;
+		gop->workers[gop->total_workers++] = new_one;
+	}
+	if(!gop->total_workers) return 0;
+
+/* Keep every worker on one of the GOPs from the current one forward */
+	for(i = gop_number;
+		i < gop_number + gop->total_workers && i < total_gops;
+		i++)
+	{
+		if(!get_worker(gop, i))
+		{
+			for(j = 0; j < gop->total_workers; j++)
+			{
+				mpeg3_gop_worker_t *test = gop->workers[j];
+				if(test->gop_number < gop_number ||
+					test->gop_number >= gop_number + gop->total_workers)
+				{
+					gop_range(track, i, &start_frame, &end_frame);
+					start_worker(gop, test, i, start_frame, end_frame);
+					break;
+				}
+			}
+		}
+	}
+
+	worker = get_worker(gop, gop_number);
+	if(worker)
+	{
+		int number = frame_number - worker->start_frame;
+
+		pthread_mutex_lock(&worker->state_lock);
+		while(worker->busy && worker->total_frames <= number)
+			pthread_cond_wait(&worker->state_cond, &worker->state_lock);
+
+		if(number < worker->total_frames)
+		{
+			*y = worker->y[number];
+			*u = worker->u[number];
+			*v = worker->v[number];
+			result = 1;
+		}
+		pthread_mutex_unlock(&worker->state_lock);
+	}
+
+	return result;
+}
+
+int64_t mpeg3_gop_usage(mpeg3_gop_t *gop)
+{
+	int64_t result = 0;
+	int i;
+	for(i = 0; i < gop->total_workers; i++)
+	{
+		mpeg3_gop_worker_t *worker = gop->workers[i];
+		pthread_mutex_lock(&worker->state_lock);
+		result += (int64_t)worker->frames_allocated *
+			(gop->y_size + gop->u_size + gop->v_size);
+		pthread_mutex_unlock(&worker->state_lock);
+	}
+	return result;
+}
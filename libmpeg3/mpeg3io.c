@@ -1,16 +1,115 @@
 #include "mpeg3private.h"
 #include "mpeg3protos.h"
 
+#include <fcntl.h>
 #include <mntent.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+
+// Every mpeg3_fs_t opening the same file shares one read only mapping.
+// The tracks of a file, copies from mpeg3_open_copy and the GOP decoders
+// all read through it instead of each filling its own buffer with fread.
+// CSS descrambling works on copies of the packets so the mapping is never
+// written.
+static mpeg3io_map_t *maps = 0;
+static pthread_mutex_t maps_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Filesystems where mmap page faults become synchronous network round trips.
+// These use fread with posix_fadvise read ahead instead.
+static int is_network_fs(int fd)
+{
+	struct statfs fs_st;
+	if(fstatfs(fd, &fs_st) < 0) return 0;
+
+	switch((uint32_t)fs_st.f_type)
+	{
+		case 0x6969:      // NFS
+		case 0x517b:      // SMB
+		case 0xff534d42:  // CIFS
+		case 0xfe534d42:  // SMB2
+		case 0x65735546:  // FUSE
+		case 0x73757245:  // CODA
+		case 0x5346414f:  // AFS
+		case 0x00c36400:  // CEPH
+			return 1;
+	}
+	return 0;
+}
+
+static mpeg3io_map_t* get_map(int fd, int64_t size)
+{
+	struct stat64 st;
+	mpeg3io_map_t *map;
+	void *data;
+
+	if(fstat64(fd, &st) < 0) return 0;
+// Don't use up the address space of 32 bit systems
+	if(sizeof(void*) < 8 && size > 0x10000000) return 0;
+
+	pthread_mutex_lock(&maps_lock);
+	for(map = maps; map; map = map->next)
+	{
+		if(map->device == st.st_dev &&
+			map->inode == st.st_ino &&
+			map->size == size)
+		{
+			map->users++;
+			pthread_mutex_unlock(&maps_lock);
+			return map;
+		}
+	}
+
+	data = mmap(0, size, PROT_READ, MAP_SHARED, fd, 0);
+	if(data == MAP_FAILED)
+	{
+		pthread_mutex_unlock(&maps_lock);
+		return 0;
+	}
+	madvise(data, size, MADV_SEQUENTIAL);
+
+	map = calloc(1, sizeof(mpeg3io_map_t));
+	map->device = st.st_dev;
+	map->inode = st.st_ino;
+	map->size = size;
+	map->data = data;
+	map->users = 1;
+	map->next = maps;
+	maps = map;
+	pthread_mutex_unlock(&maps_lock);
+	return map;
+}
+
+static void put_map(mpeg3io_map_t *map)
+{
+	mpeg3io_map_t **ptr;
+
+	pthread_mutex_lock(&maps_lock);
+	if(--map->users <= 0)
+	{
+		for(ptr = &maps; *ptr; ptr = &(*ptr)->next)
+		{
+			if(*ptr == map)
+			{
+				*ptr = map->next;
+				break;
+			}
+		}
+		munmap(map->data, map->size);
+		free(map);
+	}
+	pthread_mutex_unlock(&maps_lock);
+}
 
 mpeg3_fs_t* mpeg3_new_fs(char *path)
 {
 	mpeg3_fs_t *fs = calloc(1, sizeof(mpeg3_fs_t));
-	fs->buffer = calloc(1, MPEG3_IO_SIZE);
+	fs->read_buffer = calloc(1, MPEG3_IO_SIZE);
+	fs->buffer = fs->read_buffer;
 // Force initial read
 	fs->buffer_position = -0xffff;
 	fs->css = mpeg3_new_css();
@@ -20,8 +119,9 @@ mpeg3_fs_t* mpeg3_new_fs(char *path)
 
 int mpeg3_delete_fs(mpeg3_fs_t *fs)
 {
+	if(fs->map) put_map(fs->map);
 	mpeg3_delete_css(fs->css);
-	free(fs->buffer);
+	free(fs->read_buffer);
 	free(fs);
 	return 0;
 }
@@ -76,13 +176,32 @@ int mpeg3io_open_file(mpeg3_fs_t *fs)
 		return 1;
 	}
 
+	fs->fadvise = 0;
+	if(is_network_fs(fileno(fs->fd)))
+	{
+		fs->fadvise = 1;
+		posix_fadvise(fileno(fs->fd), 0, 0, POSIX_FADV_SEQUENTIAL);
+	}
+	else
+	if(!fs->map)
+	{
+		fs->map = get_map(fileno(fs->fd), fs->total_bytes);
+	}
+
 	fs->current_byte = 0;
+	fs->buffer = fs->read_buffer;
 	fs->buffer_position = -0xffff;
+	fs->buffer_size = 0;
 	return 0;
 }
 
 int mpeg3io_close_file(mpeg3_fs_t *fs)
 {
+	if(fs->map) put_map(fs->map);
+	fs->map = 0;
+	fs->buffer = fs->read_buffer;
+	fs->buffer_position = -0xffff;
+	fs->buffer_size = 0;
 	if(fs->fd) fclose(fs->fd);
 	fs->fd = 0;
 	return 0;
@@ -118,9 +237,24 @@ int mpeg3io_read_data(unsigned char *buffer, int64_t bytes, mpeg3_fs_t *fs)
 	return (result && bytes);
 }
 
+// Start paging in the new position of a mapped file
+static void map_seek(mpeg3_fs_t *fs, int64_t byte)
+{
+	int64_t page = getpagesize();
+	int64_t start, size;
+
+	if(byte < 0 || byte >= fs->map->size) return;
+	if(llabs(byte - fs->current_byte) < MPEG3_IO_SIZE) return;
+
+	start = byte & ~(page - 1);
+	size = MIN(MPEG3_IO_SIZE, fs->map->size - start);
+	madvise(fs->map->data + start, size, MADV_WILLNEED);
+}
+
 int mpeg3io_seek(mpeg3_fs_t *fs, int64_t byte)
 {
 //printf("mpeg3io_seek 1 %lld\n", byte);
+	if(fs->map) map_seek(fs, byte);
 	fs->current_byte = byte;
 	return (fs->current_byte < 0) || (fs->current_byte > fs->total_bytes);
 }
@@ -135,6 +269,26 @@ int mpeg3io_seek_relative(mpeg3_fs_t *fs, int64_t bytes)
 
 void mpeg3io_read_buffer(mpeg3_fs_t *fs)
 {
+// The whole mapping is the buffer
+	if(fs->map &&
+		fs->current_byte >= 0 &&
+		fs->current_byte < fs->map->size)
+	{
+		fs->buffer = fs->map->data;
+		fs->buffer_position = 0;
+		fs->buffer_size = fs->map->size;
+		fs->buffer_offset = fs->current_byte;
+		return;
+	}
+
+// Outside the mapping if the file grew after opening
+	if(fs->buffer != fs->read_buffer)
+	{
+		fs->buffer = fs->read_buffer;
+		fs->buffer_position = -0xffff;
+		fs->buffer_size = 0;
+	}
+
 // Special case for sequential reverse buffer.
 // This is only used for searching for previous codes.
 // Here we move a full half buffer backwards since the search normally
@@ -181,6 +335,13 @@ void mpeg3io_read_buffer(mpeg3_fs_t *fs)
 //printf("mpeg3io_read_buffer 2 %llx %llx\n", fs->buffer_position, ftell(fs->fd));
 		fs->buffer_size = fread(fs->buffer, 1, MPEG3_IO_SIZE, fs->fd);
 
+// Have the kernel fetch the following buffers while this one is parsed
+		if(fs->fadvise && fs->buffer_size == MPEG3_IO_SIZE)
+			posix_fadvise(fileno(fs->fd),
+				fs->buffer_position + MPEG3_IO_SIZE,
+				MPEG3_IO_SIZE * MPEG3_IO_READAHEAD,
+				POSIX_FADV_WILLNEED);
+
 
 
 /*
@@ -6,6 +6,7 @@
 #include <stdint.h>
 
 #include <stdio.h>
+#include <sys/types.h>
 
 
 
@@ -28,8 +29,8 @@
 #define MPEG3_IFO_PREFIX                 0x44564456
 #define MPEG3_IO_SIZE                    0x100000     /* Bytes read by mpeg3io at a time */
 //#define MPEG3_IO_SIZE                    0x800          /* Bytes read by mpeg3io at a time */
+#define MPEG3_IO_READAHEAD               4            /* Buffers to prefetch on network filesystems */
 #define MPEG3_RIFF_CODE                  0x52494646
-#define MPEG3_PROC_CPUINFO               "/proc/cpuinfo"
 #define MPEG3_RAW_SIZE                   0x100000     /* Largest possible packet */
 #define MPEG3_BD_PACKET_SIZE             192
 #define MPEG3_TS_PACKET_SIZE             188
@@ -184,12 +185,28 @@ typedef struct
 
 
 
+/* Whole file mapped once and shared by every mpeg3_fs_t which opens it */
+typedef struct mpeg3io_map_s
+{
+	dev_t device;
+	ino_t inode;
+	int64_t size;
+	unsigned char *data;
+	int users;
+	struct mpeg3io_map_s *next;
+} mpeg3io_map_t;
+
 typedef struct
 {
 	FILE *fd;
 	mpeg3_css_t *css;          /* Encryption object */
 	char path[MPEG3_STRLEN];
-	unsigned char *buffer;   /* Readahead buffer */
+/* Readahead buffer.  Points into the mapping if the file is mapped. */
+	unsigned char *buffer;
+	unsigned char *read_buffer;  /* Used when the file isn't mapped */
+	mpeg3io_map_t *map;
+/* Use posix_fadvise to prefetch the next buffers */
+	int fadvise;
 	int64_t buffer_offset;      /* Current buffer position */
 	int64_t buffer_size;        /* Bytes in buffer */
 	int64_t buffer_position;    /* Byte in file of start of buffer */
@@ -680,6 +697,38 @@ typedef struct
 
 
 
+/* Packet copied from the demuxer for a TOC track thread */
+typedef struct
+{
+	unsigned char *data;
+	int size;
+	int allocated;
+/* Starting byte of the packet */
+	int64_t offset;
+/* Byte after the packet */
+	int64_t eof;
+} mpeg3_toc_packet_t;
+
+#define MPEG3_TOC_PACKETS 256
+
+/* Scans the packets of 1 track while the demuxer reads the next ones */
+typedef struct
+{
+	void *file;
+	void *track;
+	int is_video;
+	int track_number;
+	pthread_t tid;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	mpeg3_toc_packet_t packets[MPEG3_TOC_PACKETS];
+	int first_packet;
+	int total_packets;
+/* Scanning the first packet outside the lock */
+	int busy;
+	int done;
+} mpeg3_toc_thread_t;
+
 typedef struct
 {
 /* Buffer of frames for index.  A frame is a high/low pair. */
@@ -727,7 +776,8 @@ typedef struct
 
 /* Starting byte of previous packet for making TOC */
 	int64_t prev_offset;
-
+/* Decodes the packets for the TOC if more than 1 cpu */
+	mpeg3_toc_thread_t *toc_thread;
 } mpeg3_atrack_t;
 
 
@@ -869,16 +919,76 @@ typedef struct
 	int u_size;
 	int v_size;
 	int64_t frame_number;
+/* Next frame in the same hash bucket or -1 */
+	int next;
 } mpeg3_cacheframe_t;
 
+/* Bytes of frames kept before the oldest frames are replaced */
+#define MPEG3_CACHE_BYTES 0x20000000
+
 typedef struct
 {
+/* Ring of frames in the order they were put.  The buffers of replaced */
+/* frames are reused by the new frames, except the last frame returned. */
 	mpeg3_cacheframe_t *frames;
 	int total;
 	int allocation;
+/* Oldest frame in the ring */
+	int first;
+/* First frame in each hash bucket or -1 */
+	int *buckets;
+/* Bytes in the frames of the ring */
+	int64_t bytes;
+	int64_t max_bytes;
+/* Buffers of the last frame returned by get_frame.  lent_owned is set */
+/* once its slot is reused and the cache has to free them. */
+	unsigned char *lent_y, *lent_u, *lent_v;
+	int lent_owned;
 } mpeg3_cache_t;
 
 
+
+/* GOP parallel decoding */
+/* Each worker decodes a whole GOP on a private copy of the file. */
+/* Limit on the frame buffers of a worker.  Frames of a GOP beyond it are */
+/* left to the main decoder. */
+#define MPEG3_GOP_BYTES 0x4000000
+typedef struct
+{
+	void *gop;
+	void *file;
+	pthread_t tid;
+	pthread_mutex_t input_lock;    /* Unlocked to start decoding a GOP */
+	pthread_mutex_t state_lock;    /* Protects the variables below */
+	pthread_cond_t state_cond;     /* Signalled for every frame and when done */
+	int done;
+	int busy;
+	int cancel;
+/* GOP being decoded or -1 */
+	int gop_number;
+	int64_t start_frame, end_frame;
+	int total_frames;              /* Frames decoded so far */
+/* One buffer per frame in the GOP.  Only resized by start_worker while the */
+/* worker is idle. */
+	unsigned char **y, **u, **v;
+	int frames_allocated;
+} mpeg3_gop_worker_t;
+
+typedef struct
+{
+	void *track;
+	int stream;
+	mpeg3_gop_worker_t *workers[MPEG3_MAX_CPUS];
+	int total_workers;
+	int y_size, u_size, v_size;
+/* Frames each worker may buffer */
+	int max_frames;
+/* Frame after the last one requested.  GOP decoding only starts once */
+/* frames are read in order. */
+	int64_t next_frame;
+} mpeg3_gop_t;
+
+
 typedef struct
 {
 	void* file;
@@ -928,6 +1038,8 @@ typedef struct
 	unsigned char *llframe0[3], *llframe1[3];
 	unsigned char *mpeg3_zigzag_scan_table;
 	unsigned char *mpeg3_alternate_scan_table;
+/* Use the SSE2 IDCT and motion compensation */
+	int use_sse2;
 // Source for the next frame presentation
 	unsigned char *output_src[3];
 /* Pointers to frame buffers. */
@@ -1014,10 +1126,13 @@ typedef struct
 	int64_t prev_frame_offset;
 /* End of stream in table of contents construction */
 	int64_t video_eof;
+/* Scans the packets for the TOC if more than 1 cpu */
+	mpeg3_toc_thread_t *toc_thread;
 
 
 	mpeg3_cache_t *frame_cache;
-
+/* Decodes upcoming GOPs in parallel if more than 1 cpu */
+	mpeg3_gop_t *gop;
 
 
 /* If these tables must be deleted by the track */
@@ -284,6 +284,18 @@ int mpeg3_ceche_has_frame(mpeg3_cache_t *ptr,
 int64_t mpeg3_cache_usage(mpeg3_cache_t *ptr);
 
 
+/* GOP PARALLEL DECODING */
+mpeg3_gop_t* mpeg3_new_gop(mpeg3_t *file, mpeg3_vtrack_t *track);
+void mpeg3_delete_gop(mpeg3_gop_t *gop);
+// Return 1 if the frame was decoded by a GOP worker.
+int mpeg3_gop_get_frame(mpeg3video_t *video,
+	int64_t frame_number,
+	unsigned char **y,
+	unsigned char **u,
+	unsigned char **v);
+int64_t mpeg3_gop_usage(mpeg3_gop_t *gop);
+
+
 
 
 
@@ -387,6 +399,7 @@ int mpeg3demux_bof(mpeg3_demuxer_t *demuxer);
 void mpeg3demux_start_reverse(mpeg3_demuxer_t *demuxer);
 void mpeg3demux_start_forward(mpeg3_demuxer_t *demuxer);
 int mpeg3demux_open_title(mpeg3_demuxer_t *demuxer, int title_number);
+int mpeg3demux_copy_titles(mpeg3_demuxer_t *dst, mpeg3_demuxer_t *src);
 /* Go to the absolute byte given */
 int mpeg3demux_seek_byte(mpeg3_demuxer_t *demuxer, int64_t byte);
 
@@ -11,6 +11,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <unistd.h>
 
 
 
@@ -87,6 +88,7 @@ int main(int argc, char *argv[])
 	int64_t total_bytes;
 	mpeg3_t *file = mpeg3_start_toc(src, dst, &total_bytes);
 	if(!file) exit(1);
+	mpeg3_set_cpus(file, sysconf(_SC_NPROCESSORS_ONLN));
 	struct timeval new_time;
 	struct timeval prev_time;
 	struct timeval start_time;
@@ -734,25 +734,21 @@ int mpeg3_update_index(mpeg3_t *file,
 
 
 
-static int handle_audio(mpeg3_t *file, 
-	int track_number)
+static void audio_packet(mpeg3_t *file, 
+	int track_number,
+	unsigned char *data,
+	int size,
+	int64_t offset,
+	int64_t eof)
 {
-	int i, j, k;
 	mpeg3_atrack_t *atrack = file->atrack[track_number];
 
 // Assume last packet of stream
-	atrack->audio_eof = mpeg3demux_tell_byte(file->demuxer);
+	atrack->audio_eof = eof;
 
 // Append demuxed data to track buffer
-	if(file->demuxer->audio_size)
-		mpeg3demux_append_data(atrack->demuxer,
-			file->demuxer->audio_buffer,
-			file->demuxer->audio_size);
-	else
-	if(file->demuxer->data_size)
-		mpeg3demux_append_data(atrack->demuxer,
-			file->demuxer->data_buffer,
-			file->demuxer->data_size);
+	if(size)
+		mpeg3demux_append_data(atrack->demuxer, data, size);
 
 /*
  * if(file->demuxer->pid == 0x1100) printf("handle_audio %p %d %d\n", 
@@ -784,31 +780,15 @@ static int handle_audio(mpeg3_t *file,
 // add downsampled samples to the index buffer and create toc entry.
 	mpeg3_update_index(file, track_number, 0);
 
-	return 0;
+	atrack->prev_offset = offset;
 }
 
 
-static int handle_video(mpeg3_t *file, 
+static int scan_video(mpeg3_t *file, 
 	mpeg3_vtrack_t *vtrack)
 {
 	mpeg3video_t *video = vtrack->video;
 
-
-// Assume last packet of stream
-	vtrack->video_eof = mpeg3demux_tell_byte(file->demuxer);
-
-// Append demuxed data to track buffer
-	if(file->demuxer->video_size)
-		mpeg3demux_append_data(vtrack->demuxer,
-			file->demuxer->video_buffer,
-			file->demuxer->video_size);
-	else
-	if(file->demuxer->data_size)
-		mpeg3demux_append_data(vtrack->demuxer,
-			file->demuxer->data_buffer,
-			file->demuxer->data_size);
-
-
 	if(vtrack->demuxer->data_size - vtrack->demuxer->data_position <
 		MPEG3_VIDEO_STREAM_SIZE) return 0;
 
@@ -901,6 +881,224 @@ static int handle_video(mpeg3_t *file,
 	return 0;
 }
 
+static void video_packet(mpeg3_t *file, 
+	mpeg3_vtrack_t *vtrack,
+	unsigned char *data,
+	int size,
+	int64_t offset,
+	int64_t eof)
+{
+// Assume last packet of stream
+	vtrack->video_eof = eof;
+
+// Append demuxed data to track buffer
+	if(size)
+		mpeg3demux_append_data(vtrack->demuxer, data, size);
+
+	scan_video(file, vtrack);
+	vtrack->prev_offset = offset;
+}
+
+
+
+
+// With more than 1 cpu, every track gets a thread which decodes its packets
+// while the demuxer reads the next ones.  The packets of a track are
+// still scanned in order so the table is the same as with 1 cpu.
+
+// liba52 fills static tables when a decoder is created.
+static pthread_mutex_t decoder_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void* toc_thread_loop(void *ptr)
+{
+	mpeg3_toc_thread_t *thread = ptr;
+	mpeg3_t *file = thread->file;
+
+	pthread_mutex_lock(&thread->lock);
+	while(1)
+	{
+		mpeg3_toc_packet_t *packet;
+
+		while(!thread->total_packets && !thread->done)
+			pthread_cond_wait(&thread->cond, &thread->lock);
+		if(!thread->total_packets) break;
+
+// The packet stays in the queue until it's scanned so it isn't overwritten
+		packet = &thread->packets[thread->first_packet];
+		pthread_mutex_unlock(&thread->lock);
+
+		if(thread->is_video)
+		{
+			video_packet(file, 
+				thread->track, 
+				packet->data, 
+				packet->size, 
+				packet->offset, 
+				packet->eof);
+		}
+		else
+		{
+			mpeg3audio_t *audio = ((mpeg3_atrack_t*)thread->track)->audio;
+			int new_decoder = !audio->ac3_decoder &&
+				!audio->layer_decoder &&
+				!audio->pcm_decoder;
+
+			if(new_decoder) pthread_mutex_lock(&decoder_lock);
+			audio_packet(file, 
+				thread->track_number, 
+				packet->data, 
+				packet->size, 
+				packet->offset, 
+				packet->eof);
+			if(new_decoder) pthread_mutex_unlock(&decoder_lock);
+		}
+
+		pthread_mutex_lock(&thread->lock);
+		thread->first_packet = (thread->first_packet + 1) % MPEG3_TOC_PACKETS;
+		thread->total_packets--;
+		pthread_cond_broadcast(&thread->cond);
+	}
+	pthread_mutex_unlock(&thread->lock);
+	return 0;
+}
+
+static mpeg3_toc_thread_t* new_toc_thread(mpeg3_t *file, 
+	void *track, 
+	int is_video, 
+	int track_number)
+{
+	mpeg3_toc_thread_t *thread = calloc(1, sizeof(mpeg3_toc_thread_t));
+	pthread_attr_t attr;
+
+	thread->file = file;
+	thread->track = track;
+	thread->is_video = is_video;
+	thread->track_number = track_number;
+	pthread_mutex_init(&thread->lock, 0);
+	pthread_cond_init(&thread->cond, 0);
+	pthread_attr_init(&attr);
+	pthread_create(&thread->tid, &attr, toc_thread_loop, thread);
+	return thread;
+}
+
+static void put_packet(mpeg3_toc_thread_t *thread, 
+	unsigned char *data, 
+	int size, 
+	int64_t offset, 
+	int64_t eof)
+{
+	mpeg3_toc_packet_t *packet;
+
+	pthread_mutex_lock(&thread->lock);
+	while(thread->total_packets >= MPEG3_TOC_PACKETS)
+		pthread_cond_wait(&thread->cond, &thread->lock);
+	packet = &thread->packets[(thread->first_packet + thread->total_packets) % 
+		MPEG3_TOC_PACKETS];
+	pthread_mutex_unlock(&thread->lock);
+
+	if(size > packet->allocated)
+	{
+		packet->data = realloc(packet->data, size);
+		packet->allocated = size;
+	}
+	if(size) memcpy(packet->data, data, size);
+	packet->size = size;
+	packet->offset = offset;
+	packet->eof = eof;
+
+	pthread_mutex_lock(&thread->lock);
+	thread->total_packets++;
+	pthread_cond_broadcast(&thread->cond);
+	pthread_mutex_unlock(&thread->lock);
+}
+
+// Wait for the queued packets to be scanned
+static void wait_toc_thread(mpeg3_toc_thread_t *thread)
+{
+	pthread_mutex_lock(&thread->lock);
+	while(thread->total_packets)
+		pthread_cond_wait(&thread->cond, &thread->lock);
+	pthread_mutex_unlock(&thread->lock);
+}
+
+static void delete_toc_thread(mpeg3_toc_thread_t *thread)
+{
+	int i;
+
+	pthread_mutex_lock(&thread->lock);
+	thread->done = 1;
+	pthread_cond_broadcast(&thread->cond);
+	pthread_mutex_unlock(&thread->lock);
+	pthread_join(thread->tid, 0);
+
+	pthread_mutex_destroy(&thread->lock);
+	pthread_cond_destroy(&thread->cond);
+	for(i = 0; i < MPEG3_TOC_PACKETS; i++)
+		if(thread->packets[i].data) free(thread->packets[i].data);
+	free(thread);
+}
+
+static void delete_toc_threads(mpeg3_t *file)
+{
+	int i;
+	for(i = 0; i < file->total_astreams; i++)
+	{
+		mpeg3_atrack_t *atrack = file->atrack[i];
+		if(atrack->toc_thread) delete_toc_thread(atrack->toc_thread);
+		atrack->toc_thread = 0;
+	}
+
+	for(i = 0; i < file->total_vstreams; i++)
+	{
+		mpeg3_vtrack_t *vtrack = file->vtrack[i];
+		if(vtrack->toc_thread) delete_toc_thread(vtrack->toc_thread);
+		vtrack->toc_thread = 0;
+	}
+}
+
+static void handle_audio(mpeg3_t *file, 
+	int track_number,
+	int64_t start_byte)
+{
+	mpeg3_atrack_t *atrack = file->atrack[track_number];
+	mpeg3_demuxer_t *demuxer = file->demuxer;
+	unsigned char *data = demuxer->data_buffer;
+	int size = demuxer->data_size;
+	int64_t eof = mpeg3demux_tell_byte(demuxer);
+
+	if(demuxer->audio_size)
+	{
+		data = demuxer->audio_buffer;
+		size = demuxer->audio_size;
+	}
+
+	if(atrack->toc_thread)
+		put_packet(atrack->toc_thread, data, size, start_byte, eof);
+	else
+		audio_packet(file, track_number, data, size, start_byte, eof);
+}
+
+static void handle_video(mpeg3_t *file, 
+	mpeg3_vtrack_t *vtrack,
+	int64_t start_byte)
+{
+	mpeg3_demuxer_t *demuxer = file->demuxer;
+	unsigned char *data = demuxer->data_buffer;
+	int size = demuxer->data_size;
+	int64_t eof = mpeg3demux_tell_byte(demuxer);
+
+	if(demuxer->video_size)
+	{
+		data = demuxer->video_buffer;
+		size = demuxer->video_size;
+	}
+
+	if(vtrack->toc_thread)
+		put_packet(vtrack->toc_thread, data, size, start_byte, eof);
+	else
+		video_packet(file, vtrack, data, size, start_byte, eof);
+}
+
 
 static void handle_subtitle(mpeg3_t *file)
 {
@@ -997,8 +1195,7 @@ int mpeg3_do_toc(mpeg3_t *file, int64_t *bytes_processed)
  * atrack->pid);
  */
 // Update an audio track
-					handle_audio(file, i);
-					atrack->prev_offset = start_byte;
+					handle_audio(file, i, start_byte);
 					got_it = 1;
 					break;
 				}
@@ -1018,6 +1215,11 @@ int mpeg3_do_toc(mpeg3_t *file, int64_t *bytes_processed)
 
 				if(atrack)
 				{
+// The threads of the other tracks read the index table
+					for(j = 0; j < file->total_astreams; j++)
+						if(file->atrack[j]->toc_thread)
+							wait_toc_thread(file->atrack[j]->toc_thread);
+
 // Create index table
 					file->total_indexes++;
 					file->indexes = realloc(file->indexes, 
@@ -1029,8 +1231,12 @@ int mpeg3_do_toc(mpeg3_t *file, int64_t *bytes_processed)
 					file->total_astreams++;
 // Make the first offset correspond to the start of the first packet.
 					mpeg3_append_samples(atrack, start_byte);
-					handle_audio(file, file->total_astreams - 1);
-					atrack->prev_offset = start_byte;
+					if(file->cpus > 1)
+						atrack->toc_thread = new_toc_thread(file, 
+							atrack, 
+							0, 
+							file->total_astreams - 1);
+					handle_audio(file, file->total_astreams - 1, start_byte);
 				}
 			}
 
@@ -1048,8 +1254,7 @@ int mpeg3_do_toc(mpeg3_t *file, int64_t *bytes_processed)
 				if(vtrack->pid == custom_id)
 				{
 // Update a video track
-					handle_video(file, vtrack);
-					vtrack->prev_offset = start_byte;
+					handle_video(file, vtrack, start_byte);
 					got_it = 1;
 					break;
 				}
@@ -1074,8 +1279,12 @@ int mpeg3_do_toc(mpeg3_t *file, int64_t *bytes_processed)
 					file->total_vstreams++;
 // Create table entry for frame 0
 					mpeg3_append_frame(vtrack, start_byte, 1);
-					handle_video(file, vtrack);
-					vtrack->prev_offset = start_byte;
+					if(file->cpus > 1)
+						vtrack->toc_thread = new_toc_thread(file, 
+							vtrack, 
+							1, 
+							file->total_vstreams - 1);
+					handle_video(file, vtrack, start_byte);
 				}
 			}
 		}
@@ -1098,6 +1307,10 @@ void mpeg3_stop_toc(mpeg3_t *file)
 {
 // Create final chunk for audio tracks to count the last samples.
 	int i, j, k;
+
+// Finish the queued packets
+	delete_toc_threads(file);
+
 	for(i = 0; i < file->total_astreams; i++)
 	{
 		mpeg3_atrack_t *atrack = file->atrack[i];
@@ -48,6 +48,7 @@ mpeg3_vtrack_t* mpeg3_new_vtrack(mpeg3_t *file,
 
 int mpeg3_delete_vtrack(mpeg3_t *file, mpeg3_vtrack_t *vtrack)
 {
+	if(vtrack->gop) mpeg3_delete_gop(vtrack->gop);
 	if(vtrack->video) mpeg3video_delete(vtrack->video);
 	if(vtrack->demuxer) mpeg3_delete_demuxer(vtrack->demuxer);
 	if(vtrack->private_offsets)
@@ -0,0 +1,166 @@
+#include "idct.h"
+
+#ifdef __SSE2__
+
+#include <emmintrin.h>
+
+/* SSE2 version of the Chen-Wang IDCT in idct.c.  */
+/* The pairs of multiplications in each stage are done with pmaddwd */
+/* in 32 bits so the output is identical to mpeg3video_idct_conversion. */
+
+#define W1 2841 /* 2048*sqrt(2)*cos(1*pi/16) */
+#define W2 2676 /* 2048*sqrt(2)*cos(2*pi/16) */
+#define W3 2408 /* 2048*sqrt(2)*cos(3*pi/16) */
+#define W5 1609 /* 2048*sqrt(2)*cos(5*pi/16) */
+#define W6 1108 /* 2048*sqrt(2)*cos(6*pi/16) */
+#define W7 565  /* 2048*sqrt(2)*cos(7*pi/16) */
+
+#define PAIR(a, b) _mm_setr_epi16(a, b, a, b, a, b, a, b)
+
+/* 181 * x in 32 bits */
+static inline __m128i mul181(__m128i x)
+{
+	return _mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(x, 7), _mm_slli_epi32(x, 5)),
+		_mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(x, 4), _mm_slli_epi32(x, 2)), x));
+}
+
+/* Store 32 bit results in shorts the way C truncates them */
+static inline __m128i pack_trunc(__m128i lo, __m128i hi)
+{
+	lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+	hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+	return _mm_packs_epi32(lo, hi);
+}
+
+static inline void transpose(__m128i *r)
+{
+	__m128i a0 = _mm_unpacklo_epi16(r[0], r[1]);
+	__m128i a1 = _mm_unpackhi_epi16(r[0], r[1]);
+	__m128i a2 = _mm_unpacklo_epi16(r[2], r[3]);
+	__m128i a3 = _mm_unpackhi_epi16(r[2], r[3]);
+	__m128i a4 = _mm_unpacklo_epi16(r[4], r[5]);
+	__m128i a5 = _mm_unpackhi_epi16(r[4], r[5]);
+	__m128i a6 = _mm_unpacklo_epi16(r[6], r[7]);
+	__m128i a7 = _mm_unpackhi_epi16(r[6], r[7]);
+	__m128i b0 = _mm_unpacklo_epi32(a0, a2);
+	__m128i b1 = _mm_unpackhi_epi32(a0, a2);
+	__m128i b2 = _mm_unpacklo_epi32(a1, a3);
+	__m128i b3 = _mm_unpackhi_epi32(a1, a3);
+	__m128i b4 = _mm_unpacklo_epi32(a4, a6);
+	__m128i b5 = _mm_unpackhi_epi32(a4, a6);
+	__m128i b6 = _mm_unpacklo_epi32(a5, a7);
+	__m128i b7 = _mm_unpackhi_epi32(a5, a7);
+	r[0] = _mm_unpacklo_epi64(b0, b4);
+	r[1] = _mm_unpackhi_epi64(b0, b4);
+	r[2] = _mm_unpacklo_epi64(b1, b5);
+	r[3] = _mm_unpackhi_epi64(b1, b5);
+	r[4] = _mm_unpacklo_epi64(b2, b6);
+	r[5] = _mm_unpackhi_epi64(b2, b6);
+	r[6] = _mm_unpacklo_epi64(b3, b7);
+	r[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+/* One pass over 4 lanes.  p17, p53 and p26 are the interleaved inputs. */
+/* col selects the scaling of mpeg3video_idctcol instead of mpeg3video_idctrow. */
+static inline void idct_lanes(__m128i b0, __m128i b4,
+	__m128i p17, __m128i p53, __m128i p26,
+	int col,
+	__m128i *out)
+{
+	__m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+	__m128i round = _mm_set1_epi32(col ? 4 : 0);
+
+	x0 = _mm_add_epi32(_mm_slli_epi32(b0, col ? 8 : 11), _mm_set1_epi32(col ? 8192 : 128));
+	x1 = _mm_slli_epi32(b4, col ? 8 : 11);
+
+/* first stage */
+	x4 = _mm_add_epi32(_mm_madd_epi16(p17, PAIR(W1, W7)), round);
+	x5 = _mm_add_epi32(_mm_madd_epi16(p17, PAIR(W7, -W1)), round);
+	x6 = _mm_add_epi32(_mm_madd_epi16(p53, PAIR(W5, W3)), round);
+	x7 = _mm_add_epi32(_mm_madd_epi16(p53, PAIR(W3, -W5)), round);
+
+/* second stage */
+	x2 = _mm_add_epi32(_mm_madd_epi16(p26, PAIR(W6, -W2)), round);
+	x3 = _mm_add_epi32(_mm_madd_epi16(p26, PAIR(W2, W6)), round);
+	if(col)
+	{
+		x4 = _mm_srai_epi32(x4, 3);
+		x5 = _mm_srai_epi32(x5, 3);
+		x6 = _mm_srai_epi32(x6, 3);
+		x7 = _mm_srai_epi32(x7, 3);
+		x2 = _mm_srai_epi32(x2, 3);
+		x3 = _mm_srai_epi32(x3, 3);
+	}
+	x8 = _mm_add_epi32(x0, x1);
+	x0 = _mm_sub_epi32(x0, x1);
+	x1 = _mm_add_epi32(x4, x6);
+	x4 = _mm_sub_epi32(x4, x6);
+	x6 = _mm_add_epi32(x5, x7);
+	x5 = _mm_sub_epi32(x5, x7);
+
+/* third stage */
+	x7 = _mm_add_epi32(x8, x3);
+	x8 = _mm_sub_epi32(x8, x3);
+	x3 = _mm_add_epi32(x0, x2);
+	x0 = _mm_sub_epi32(x0, x2);
+	x2 = _mm_srai_epi32(_mm_add_epi32(mul181(_mm_add_epi32(x4, x5)), _mm_set1_epi32(128)), 8);
+	x4 = _mm_srai_epi32(_mm_add_epi32(mul181(_mm_sub_epi32(x4, x5)), _mm_set1_epi32(128)), 8);
+
+/* fourth stage */
+#define OUT(i, x) out[i] = col ? _mm_srai_epi32(x, 14) : _mm_srai_epi32(x, 8)
+	OUT(0, _mm_add_epi32(x7, x1));
+	OUT(1, _mm_add_epi32(x3, x2));
+	OUT(2, _mm_add_epi32(x0, x4));
+	OUT(3, _mm_add_epi32(x8, x6));
+	OUT(4, _mm_sub_epi32(x8, x6));
+	OUT(5, _mm_sub_epi32(x0, x4));
+	OUT(6, _mm_sub_epi32(x3, x2));
+	OUT(7, _mm_sub_epi32(x7, x1));
+#undef OUT
+}
+
+/* r[l] holds coefficient l for 8 lanes */
+static inline void idct_pass(__m128i *r, int col)
+{
+	__m128i zero = _mm_setzero_si128();
+	__m128i lo[8], hi[8];
+	int i;
+
+	idct_lanes(_mm_srai_epi32(_mm_unpacklo_epi16(zero, r[0]), 16),
+		_mm_srai_epi32(_mm_unpacklo_epi16(zero, r[4]), 16),
+		_mm_unpacklo_epi16(r[1], r[7]),
+		_mm_unpacklo_epi16(r[5], r[3]),
+		_mm_unpacklo_epi16(r[2], r[6]),
+		col,
+		lo);
+	idct_lanes(_mm_srai_epi32(_mm_unpackhi_epi16(zero, r[0]), 16),
+		_mm_srai_epi32(_mm_unpackhi_epi16(zero, r[4]), 16),
+		_mm_unpackhi_epi16(r[1], r[7]),
+		_mm_unpackhi_epi16(r[5], r[3]),
+		_mm_unpackhi_epi16(r[2], r[6]),
+		col,
+		hi);
+
+	for(i = 0; i < 8; i++)
+		r[i] = pack_trunc(lo[i], hi[i]);
+}
+
+void mpeg3video_idct_conversion_sse2(short* block)
+{
+	__m128i r[8];
+	int i;
+
+	for(i = 0; i < 8; i++)
+		r[i] = _mm_loadu_si128((__m128i*)(block + 8 * i));
+
+/* Rows become lanes for the horizontal pass */
+	transpose(r);
+	idct_pass(r, 0);
+	transpose(r);
+	idct_pass(r, 1);
+
+	for(i = 0; i < 8; i++)
+		_mm_storeu_si128((__m128i*)(block + 8 * i), r[i]);
+}
+
+#endif
@@ -4,41 +4,40 @@
 #include <stdio.h>
 #include <string.h>
 
+#if defined(X86_CPU) && (defined(__i386__) || defined(__x86_64__))
+#include <cpuid.h>
+
+/* Feature flags in edx of cpuid function 1 */
+static int cpuid_features()
+{
+	unsigned int eax, ebx, ecx, edx;
+	if(!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return 0;
+	return edx;
+}
+#endif
+
 int mpeg3_mmx_test()
 {
 	int result = 0;
-	FILE *proc;
-	char string[MPEG3_STRLEN];
-
-
-#ifdef HAVE_MMX
-	if(!(proc = fopen(MPEG3_PROC_CPUINFO, "r")))
-	{
-		fprintf(stderr, "mpeg3_mmx_test: failed to open /proc/cpuinfo\n");
-		return 0;
-	}
-	
-	while(fgets(string, MPEG3_STRLEN, proc))
-	{
-/* Got the flags line */
-		if(!strncasecmp(string, "flags", 5))
-		{
-			char *needle;
-			needle = strstr(string, "mmx");
-			if(!needle)
-            {
-            	fclose(proc);
-            	return 0;
-            }
-			if(!strncasecmp(needle, "mmx", 3))
-            {
-            	fclose(proc);
-            	return 1;
-            }
-		}
-	}
-   	fclose(proc);
+
+#if defined(HAVE_MMX) && defined(X86_CPU) && (defined(__i386__) || defined(__x86_64__))
+	result = (cpuid_features() & (1 << 23)) != 0;
+#endif
+
+	return result;
+}
+
+int mpeg3_sse2_test()
+{
+	int result = 0;
+
+#ifdef __SSE2__
+#ifdef __x86_64__
+	result = 1;
+#elif defined(X86_CPU) && defined(__i386__)
+	result = (cpuid_features() & (1 << 26)) != 0;
+#endif
 #endif
 
-	return 0;
+	return result;
 }
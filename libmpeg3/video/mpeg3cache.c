@@ -7,10 +7,99 @@
 
 // This is basically qtcache.c with quicktime_ replaced by mpeg3_
 
+// The frames are a ring in the order they were put.  A frame number is
+// found through a hash table with a bucket for every frame in the ring.
+// When the ring is full or the frames use more than max_bytes, the oldest
+// frame is replaced and its buffers are reused.  The buffers of the frame
+// last returned by get_frame aren't reused, so the caller can keep reading
+// them until its next get_frame.
+
+
+#define BUCKET(ptr, frame_number) ((frame_number) & ((ptr)->allocation - 1))
+
+static mpeg3_cacheframe_t* find_frame(mpeg3_cache_t *ptr,
+	int64_t frame_number)
+{
+	int i;
+
+	if(!ptr->total) return 0;
+	for(i = ptr->buckets[BUCKET(ptr, frame_number)]; i >= 0; i = ptr->frames[i].next)
+	{
+		if(ptr->frames[i].frame_number == frame_number)
+			return &ptr->frames[i];
+	}
+	return 0;
+}
+
+static void rehash(mpeg3_cache_t *ptr)
+{
+	int i;
+
+	for(i = 0; i < ptr->allocation; i++)
+		ptr->buckets[i] = -1;
+
+	for(i = 0; i < ptr->total; i++)
+	{
+		int number = (ptr->first + i) % ptr->allocation;
+		mpeg3_cacheframe_t *frame = &ptr->frames[number];
+		int bucket = BUCKET(ptr, frame->frame_number);
+		frame->next = ptr->buckets[bucket];
+		ptr->buckets[bucket] = number;
+	}
+}
+
+/* Drop the oldest frame but keep its buffers */
+static void drop_first(mpeg3_cache_t *ptr)
+{
+	mpeg3_cacheframe_t *frame = &ptr->frames[ptr->first];
+	int *link = &ptr->buckets[BUCKET(ptr, frame->frame_number)];
+
+	while(*link != ptr->first) link = &ptr->frames[*link].next;
+	*link = frame->next;
+
+	ptr->bytes -= frame->y_size + frame->u_size + frame->v_size;
+	ptr->first = (ptr->first + 1) % ptr->allocation;
+	ptr->total--;
+}
+
+/* Free the buffers of the last frame returned if they left the ring */
+static void release_lent(mpeg3_cache_t *ptr)
+{
+	if(ptr->lent_owned)
+	{
+		if(ptr->lent_y) free(ptr->lent_y);
+		if(ptr->lent_u) free(ptr->lent_u);
+		if(ptr->lent_v) free(ptr->lent_v);
+	}
+	ptr->lent_y = ptr->lent_u = ptr->lent_v = 0;
+	ptr->lent_owned = 0;
+}
+
+/* Double the ring with the oldest frame first */
+static void expand(mpeg3_cache_t *ptr)
+{
+	int new_allocation = ptr->allocation * 2;
+	mpeg3_cacheframe_t *new_frames;
+	int i;
+
+	if(!new_allocation) new_allocation = 32;
+	new_frames = calloc(new_allocation, sizeof(mpeg3_cacheframe_t));
+	for(i = 0; i < ptr->allocation; i++)
+		new_frames[i] = ptr->frames[(ptr->first + i) % ptr->allocation];
+
+	if(ptr->frames) free(ptr->frames);
+	if(ptr->buckets) free(ptr->buckets);
+	ptr->frames = new_frames;
+	ptr->buckets = calloc(new_allocation, sizeof(int));
+	ptr->allocation = new_allocation;
+	ptr->first = 0;
+	rehash(ptr);
+}
 
 mpeg3_cache_t* mpeg3_new_cache()
 {
 	mpeg3_cache_t *result = calloc(1, sizeof(mpeg3_cache_t));
+	result->max_bytes = MPEG3_CACHE_BYTES;
 	return result;
 }
 
@@ -27,13 +116,18 @@ void mpeg3_delete_cache(mpeg3_cache_t *ptr)
 			if(frame->v) free(frame->v);
 		}
 		free(ptr->frames);
-		free(ptr);
+		free(ptr->buckets);
 	}
+	release_lent(ptr);
+	free(ptr);
 }
 
 void mpeg3_reset_cache(mpeg3_cache_t *ptr)
 {
 	ptr->total = 0;
+	ptr->first = 0;
+	ptr->bytes = 0;
+	if(ptr->buckets) rehash(ptr);
 }
 
 void mpeg3_cache_put_frame(mpeg3_cache_t *ptr,
@@ -46,63 +140,82 @@ void mpeg3_cache_put_frame(mpeg3_cache_t *ptr,
 	int v_size)
 {
 	mpeg3_cacheframe_t *frame = 0;
-	int i;
+	int number, bucket;
 
-//printf("mpeg3_put_frame 1\n");
 // Get existing frame
-	for(i = 0; i < ptr->total; i++)
-	{
-		if(ptr->frames[i].frame_number == frame_number)
-		{
-			frame = &ptr->frames[i];
-			break;
-		}
-	}
+	if(find_frame(ptr, frame_number)) return;
 
+// Replace the oldest frames until the new one fits in the budget
+	while(ptr->total && 
+		ptr->bytes + y_size + u_size + v_size > ptr->max_bytes)
+		drop_first(ptr);
 
-	if(!frame)
-	{
-		if(ptr->total >= ptr->allocation)
-		{
-			int new_allocation = ptr->allocation * 2;
-//printf("mpeg3_put_frame 10 %d\n", new_allocation);
-			if(!new_allocation) new_allocation = 32;
-			ptr->frames = realloc(ptr->frames, 
-				sizeof(mpeg3_cacheframe_t) * new_allocation);
-			bzero(ptr->frames + ptr->total,
-				sizeof(mpeg3_cacheframe_t) * (new_allocation - ptr->allocation));
-//printf("mpeg3_put_frame 20 %d %d %d\n", new_allocation, ptr->allocation, ptr->total);
-			ptr->allocation = new_allocation;
-		}
+	if(ptr->total >= ptr->allocation) expand(ptr);
 
-		frame = &ptr->frames[ptr->total];
-//printf("mpeg3_put_frame 30 %d %p %p %p\n", ptr->total, frame->y, frame->u, frame->v);
-		ptr->total++;
+	number = (ptr->first + ptr->total) % ptr->allocation;
+	frame = &ptr->frames[number];
+	ptr->total++;
+
+// Take the buffers of the last frame returned out of the ring
+	if(!ptr->lent_owned &&
+		(frame->y || frame->u || frame->v) &&
+		frame->y == ptr->lent_y &&
+		frame->u == ptr->lent_u &&
+		frame->v == ptr->lent_v)
+	{
+		ptr->lent_owned = 1;
+		frame->y = frame->u = frame->v = 0;
+		frame->y_size = frame->u_size = frame->v_size = 0;
+	}
 
 // Memcpy is a lot slower than just dropping the seeking frames.
-		if(y) 
-		{
-			frame->y = realloc(frame->y, y_size);
-			frame->y_size = y_size;
-			memcpy(frame->y, y, y_size);
-		}
+	if(y) 
+	{
+		if(frame->y_size != y_size) frame->y = realloc(frame->y, y_size);
+		frame->y_size = y_size;
+		memcpy(frame->y, y, y_size);
+	}
+	else
+	if(frame->y)
+	{
+		free(frame->y);
+		frame->y = 0;
+		frame->y_size = 0;
+	}
 
-		if(u)
-		{
-			frame->u = realloc(frame->u, u_size);
-			frame->u_size = u_size;
-			memcpy(frame->u, u, u_size);
-		}
+	if(u)
+	{
+		if(frame->u_size != u_size) frame->u = realloc(frame->u, u_size);
+		frame->u_size = u_size;
+		memcpy(frame->u, u, u_size);
+	}
+	else
+	if(frame->u)
+	{
+		free(frame->u);
+		frame->u = 0;
+		frame->u_size = 0;
+	}
 
-		if(v)
-		{
-			frame->v = realloc(frame->v, v_size);
-			frame->v_size = v_size;
-			memcpy(frame->v, v, v_size);
-		}
-		frame->frame_number = frame_number;
+	if(v)
+	{
+		if(frame->v_size != v_size) frame->v = realloc(frame->v, v_size);
+		frame->v_size = v_size;
+		memcpy(frame->v, v, v_size);
+	}
+	else
+	if(frame->v)
+	{
+		free(frame->v);
+		frame->v = 0;
+		frame->v_size = 0;
 	}
-//printf("mpeg3_put_frame 100\n");
+	frame->frame_number = frame_number;
+	ptr->bytes += frame->y_size + frame->u_size + frame->v_size;
+
+	bucket = BUCKET(ptr, frame_number);
+	frame->next = ptr->buckets[bucket];
+	ptr->buckets[bucket] = number;
 }
 
 int mpeg3_cache_get_frame(mpeg3_cache_t *ptr,
@@ -111,39 +224,24 @@ int mpeg3_cache_get_frame(mpeg3_cache_t *ptr,
 	unsigned char **u,
 	unsigned char **v)
 {
-	int i;
+	mpeg3_cacheframe_t *frame = find_frame(ptr, frame_number);
 
-	for(i = 0; i < ptr->total; i++)
+	release_lent(ptr);
+	if(frame)
 	{
-		mpeg3_cacheframe_t *frame = &ptr->frames[i];
-		if(frame->frame_number == frame_number)
-		{
-			
-			*y = frame->y;
-			*u = frame->u;
-			*v = frame->v;
-			return 1;
-			break;
-		}
+		*y = ptr->lent_y = frame->y;
+		*u = ptr->lent_u = frame->u;
+		*v = ptr->lent_v = frame->v;
+		return 1;
 	}
 
 	return 0;
 }
 
-
 int mpeg3_cache_has_frame(mpeg3_cache_t *ptr,
 	int64_t frame_number)
 {
-	int i;
-
-	for(i = 0; i < ptr->total; i++)
-	{
-		mpeg3_cacheframe_t *frame = &ptr->frames[i];
-		if(frame->frame_number == frame_number)
-			return 1;
-	}
-
-	return 0;
+	return find_frame(ptr, frame_number) != 0;
 }
 
 int64_t mpeg3_cache_usage(mpeg3_cache_t *ptr)
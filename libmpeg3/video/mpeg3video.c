@@ -226,6 +226,7 @@ mpeg3video_t* mpeg3video_allocate_struct(mpeg3_t *file, mpeg3_vtrack_t *track)
 
 	mpeg3video_init_scantables(video);
 	mpeg3video_init_output();
+	video->use_sse2 = mpeg3_sse2_test();
 
 	pthread_mutexattr_init(&mutex_attr);
 //	pthread_mutexattr_setkind_np(&mutex_attr, PTHREAD_MUTEX_FAST_NP);
@@ -530,6 +531,7 @@ int mpeg3video_set_cpus(mpeg3video_t *video, int cpus)
 int mpeg3video_set_mmx(mpeg3video_t *video, int use_mmx)
 {
 	mpeg3video_init_scantables(video);
+	video->use_sse2 = use_mmx && mpeg3_sse2_test();
 	return 0;
 }
 
@@ -567,6 +569,26 @@ int mpeg3video_read_raw(mpeg3video_t *video,
 
 
 
+// Transfer a frame decoded by a GOP worker with cropping
+static void present_gop_frame(mpeg3video_t *video,
+	unsigned char *y,
+	unsigned char *u,
+	unsigned char *v)
+{
+	unsigned char *temp[3];
+	temp[0] = video->output_src[0];
+	temp[1] = video->output_src[1];
+	temp[2] = video->output_src[2];
+
+	video->output_src[0] = y;
+	video->output_src[1] = u;
+	video->output_src[2] = v;
+	mpeg3video_present_frame(video);
+	video->output_src[0] = temp[0];
+	video->output_src[1] = temp[1];
+	video->output_src[2] = temp[2];
+}
+
 int mpeg3video_read_frame(mpeg3video_t *video, 
 		unsigned char **output_rows,
 		int in_x, 
@@ -646,6 +668,14 @@ int mpeg3video_read_frame(mpeg3video_t *video,
 			video->frame_seek = ++frame_number;
 	}
 	else
+// Recover from GOP workers
+	if(mpeg3_gop_get_frame(video, frame_number, &y, &u, &v))
+	{
+		present_gop_frame(video, y, u, v);
+// The main decoder didn't move so seek it if the workers stop
+		video->frame_seek = frame_number + 1;
+	}
+	else
 	{
 
 // Only decode if it's a different frame
@@ -734,6 +764,12 @@ int mpeg3video_read_yuvframe(mpeg3video_t *video,
 			video->frame_seek = ++frame_number;
 	}
 	else
+	if(mpeg3_gop_get_frame(video, frame_number, &y, &u, &v))
+	{
+		present_gop_frame(video, y, u, v);
+		video->frame_seek = frame_number + 1;
+	}
+	else
 	{
 		if(!result) result = mpeg3video_seek(video);
 		if(!result) result = mpeg3video_read_frame_backend(video, 0);
@@ -776,6 +812,14 @@ int mpeg3video_read_yuvframe_ptr(mpeg3video_t *video,
 			video->frame_seek = ++frame_number;
 	}
 	else
+	if(mpeg3_gop_get_frame(video, frame_number, &y, &u, &v))
+	{
+		*y_output = (char*)y;
+		*u_output = (char*)u;
+		*v_output = (char*)v;
+		video->frame_seek = frame_number + 1;
+	}
+	else
 // Only decode if it's a different frame
 	if(video->frame_seek < 0 || 
 		video->last_number < 0 ||
@@ -2,6 +2,8 @@
 #define MPEG3VIDEOPROTOS_H
 
 void mpeg3video_idct_conversion(short* block);
+void mpeg3video_idct_conversion_sse2(short* block);
+void mpeg3video_recon_sse2(unsigned char *s, unsigned char *d, int lx, int lx2, int w, int h, int xh, int yh, int addflag);
 unsigned int mpeg3slice_showbits(mpeg3_slice_buffer_t *slice_buffer, int bits);
 
 #endif
@@ -0,0 +1,76 @@
+#ifdef __SSE2__
+
+#include <emmintrin.h>
+
+/* SSE2 version of the rec* functions in reconstruct.c. */
+/* pavgb rounds up like the C versions so the output is identical. */
+
+#define LOAD16(p) _mm_loadu_si128((__m128i*)(p))
+#define LOAD8(p) _mm_loadl_epi64((__m128i*)(p))
+
+/* (a + b + c + d + 2) >> 2 */
+static inline __m128i avg4(__m128i a, __m128i b, __m128i c, __m128i d)
+{
+	__m128i zero = _mm_setzero_si128();
+	__m128i round = _mm_set1_epi16(2);
+	__m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(a, zero),
+			_mm_unpacklo_epi8(b, zero)),
+		_mm_add_epi16(_mm_unpacklo_epi8(c, zero),
+			_mm_unpacklo_epi8(d, zero)));
+	__m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(a, zero),
+			_mm_unpackhi_epi8(b, zero)),
+		_mm_add_epi16(_mm_unpackhi_epi8(c, zero),
+			_mm_unpackhi_epi8(d, zero)));
+	lo = _mm_srli_epi16(_mm_add_epi16(lo, round), 2);
+	hi = _mm_srli_epi16(_mm_add_epi16(hi, round), 2);
+	return _mm_packus_epi16(lo, hi);
+}
+
+/* w is 16 or 8.  xh and yh select the half pel case. */
+void mpeg3video_recon_sse2(unsigned char *s,
+	unsigned char *d,
+	int lx,
+	int lx2,
+	int w,
+	int h,
+	int xh,
+	int yh,
+	int addflag)
+{
+	int j;
+
+/* Don't read past the block since 8 pixel chroma blocks may end a row */
+#define LOADW(p) (w == 16 ? LOAD16(p) : LOAD8(p))
+	for(j = 0; j < h; j++)
+	{
+		__m128i p;
+
+		if(!xh && !yh)
+			p = LOADW(s);
+		else
+		if(!xh && yh)
+			p = _mm_avg_epu8(LOADW(s), LOADW(s + lx));
+		else
+		if(xh && !yh)
+			p = _mm_avg_epu8(LOADW(s), LOADW(s + 1));
+		else
+			p = avg4(LOADW(s), LOADW(s + 1), LOADW(s + lx), LOADW(s + lx + 1));
+
+		if(w == 16)
+		{
+			if(addflag) p = _mm_avg_epu8(p, LOAD16(d));
+			_mm_storeu_si128((__m128i*)d, p);
+		}
+		else
+		{
+			if(addflag) p = _mm_avg_epu8(p, LOAD8(d));
+			_mm_storel_epi64((__m128i*)d, p);
+		}
+
+		s += lx2;
+		d += lx2;
+	}
+#undef LOADW
+}
+
+#endif
@@ -1,5 +1,6 @@
 #include "mpeg3private.h"
 #include "mpeg3protos.h"
+#include "mpeg3videoprotos.h"
 #include <stdio.h>
 
 
@@ -437,6 +438,14 @@ void recon_comp(mpeg3video_t *video,
 	s = src + lx * (y + (dy >> 1)) + x + (dx >> 1);
 	d = dst + lx * y + x;
 
+#ifdef __SSE2__
+	if(video->use_sse2)
+	{
+		mpeg3video_recon_sse2(s, d, lx, lx2, w ? 16 : 8, h, dx & 1, dy & 1, addflag);
+		return;
+	}
+#endif
+
 // Accelerated functions
 	switch(switcher)
 	{
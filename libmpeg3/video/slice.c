@@ -464,6 +464,11 @@ int mpeg3_decode_slice(mpeg3_slice_t *slice)
 		{
       		if((cbp | snr_cbp) & (1 << (video->blk_cnt - 1 - comp)))
 			{
+#ifdef __SSE2__
+				if(video->use_sse2)
+					mpeg3video_idct_conversion_sse2(slice->block[comp]);
+				else
+#endif
        			mpeg3video_idct_conversion(slice->block[comp]);
 
         		mpeg3video_addblock(slice, 
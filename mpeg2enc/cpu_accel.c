@@ -31,6 +31,11 @@ static int x86_accel (void)
     int AMD;
     int caps;
 
+#ifdef __x86_64__
+// The MMX assembly is 32 bit only but SSE2 is always there.
+    return ACCEL_X86_SSE2;
+#else
+
 #define cpuid(op,eax,ebx,ecx,edx)	\
     asm ("cpuid"			\
 	 : "=a" (eax),			\
@@ -69,6 +74,8 @@ static int x86_accel (void)
     caps = ACCEL_X86_MMX;
     if (edx & 0x02000000)	// SSE - identical to AMD MMX extensions
 	caps = ACCEL_X86_MMX | ACCEL_X86_MMXEXT;
+    if (edx & 0x04000000)	// SSE2
+	caps |= ACCEL_X86_SSE2;
 
     cpuid (0x80000000, eax, ebx, ecx, edx);
     if (eax < 0x80000001)	// no extended capabilities
@@ -85,6 +92,7 @@ static int x86_accel (void)
 	}
 
     return caps;
+#endif
 }
 #endif
 
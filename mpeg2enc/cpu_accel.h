@@ -25,5 +25,6 @@
 #define ACCEL_X86_MMX	0x80000000
 #define ACCEL_X86_3DNOW	0x40000000
 #define ACCEL_X86_MMXEXT	0x20000000
+#define ACCEL_X86_SSE2	0x10000000
 
 int cpu_accel (void);
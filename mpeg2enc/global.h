@@ -32,6 +32,7 @@
 #include "quicktime.h"
 
 #include <pthread.h>
+#include <setjmp.h>
 #include <stdint.h>
 
 /* choose between declaration (GLOBAL_ undefined)
@@ -233,6 +234,7 @@ typedef struct
 	pthread_mutex_t input_lock, output_lock;
 	pthread_t tid;   /* ID of thread */
 	int done;
+	struct mpeg2enc_s *encoder;
 
 	motion_comp_s *motion_comp;
 	pict_data_s *pict_data;
@@ -361,10 +363,15 @@ typedef struct
   pthread_mutex_t input_lock, output_lock;
   pthread_t tid;   /* ID of thread */
   int done;
+  struct mpeg2enc_s *encoder;
 
   pict_data_s *picture;
   unsigned char **pred;
   unsigned char **cur;
+/* References for the prediction done before the forward transform */
+  unsigned char **reff;
+  unsigned char **refb;
+  int secondfield;
 // Temp for MMX
   unsigned char temp[128];
 } transform_engine_t;
@@ -375,6 +382,7 @@ typedef struct
 	pthread_mutex_t input_lock, output_lock;
 	pthread_t tid;   /* ID of thread */
 	int done;
+	struct mpeg2enc_s *encoder;
 
 	int prev_mquant;
 
@@ -391,28 +399,6 @@ typedef struct
 	int outcnt;
 } slice_engine_t;
 
-EXTERN_ pthread_mutex_t test_lock;
-EXTERN_ motion_engine_t *motion_engines;
-EXTERN_ transform_engine_t *transform_engines;
-EXTERN_ transform_engine_t *itransform_engines;
-EXTERN_ slice_engine_t *slice_engines;
-EXTERN_ ratectl_t **ratectl;
-EXTERN_ int quiet; /* suppress warnings */
-
-
-
-
-EXTERN_ pict_data_s cur_picture;
-
-/* reconstructed frames */
-EXTERN_ unsigned char *newrefframe[3], *oldrefframe[3], *auxframe[3];
-/* original frames */
-EXTERN_ unsigned char *neworgframe[3], *oldorgframe[3], *auxorgframe[3];
-/* prediction of current frame */
-EXTERN_ unsigned char *predframe[3];
-/* motion estimation parameters */
-EXTERN_ struct motion_data *motion_data;
-
 /* SCale factor for fast integer arithmetic routines */
 /* Changed this and you *must* change the quantisation routines as they depend on its absolute
 	value */
@@ -420,35 +406,6 @@ EXTERN_ struct motion_data *motion_data;
 #define IQUANT_SCALE (1<<IQUANT_SCALE_POW2)
 #define COEFFSUM_SCALE (1<<16)
 
-/* Orginal intra / non_intra quantization matrices */
-EXTERN_ uint16_t intra_q[64], inter_q[64];
-EXTERN_ uint16_t i_intra_q[64], i_inter_q[64];
-
-/* Table driven intra / non-intra quantization matrices */
-EXTERN_ uint16_t intra_q_tbl[113][64], inter_q_tbl[113][64];
-EXTERN_ uint16_t i_intra_q_tbl[113][64], i_inter_q_tbl[113][64];
-EXTERN_ float intra_q_tblf[113][64], inter_q_tblf[113][64];
-EXTERN_ float i_intra_q_tblf[113][64], i_inter_q_tblf[113][64];
-
-EXTERN_ uint16_t chrom_intra_q[64],chrom_inter_q[64];
-
-
-
-
-
-/* clipping (=saturation) table */
-EXTERN_ unsigned char *clp;
-
-/* name strings */
-EXTERN_ char id_string[256], tplorg[256], tplref[256], out_path[256];
-EXTERN_ char iqname[256], niqname[256];
-EXTERN_ char statname[256];
-EXTERN_ char errortext[256];
-
-EXTERN_ FILE *outfile; /* file descriptors */
-EXTERN_ FILE *statfile; /* file descriptors */
-EXTERN_ int inputtype; /* format of input frames */
-
 /*
   How many frames to read ahead (eventually intended to support
   scene change based GOP structuring.  READ_LOOK_AHEAD/2 must be
@@ -460,112 +417,173 @@ EXTERN_ int inputtype; /* format of input frames */
 */
 
 #define READ_LOOK_AHEAD 4 
-EXTERN_ uint8_t ***frame_buffers;
-
-
-/* These determine what input format to use */
-EXTERN_ quicktime_t *qt_file;
-EXTERN_ mpeg3_t *mpeg_file;
-EXTERN_ int do_stdin;
-EXTERN_ FILE *stdin_fd;
-
-
-EXTERN_ int do_buffers;
-EXTERN_ pthread_mutex_t input_lock;
-EXTERN_ pthread_mutex_t output_lock;
-EXTERN_ pthread_mutex_t copy_lock;
-EXTERN_ char *input_buffer_y;
-EXTERN_ char *input_buffer_u;
-EXTERN_ char *input_buffer_v;
-EXTERN_ int input_buffer_end;
-
-
-EXTERN_ int verbose;
-EXTERN_ quicktime_t *qt_output;
-EXTERN_ unsigned char *frame_buffer;
-EXTERN_ unsigned char **row_pointers;
-EXTERN_ int fixed_mquant;
-EXTERN_ double quant_floor;    		/* quantisation floor [1..10] (0 for CBR) */
-EXTERN_ double act_boost;		/* Quantisation reduction for highly active blocks */
-EXTERN_ int use_hires_quant;
-EXTERN_ int use_denoise_quant;
-/* Number of processors */
-EXTERN_ int processors;
-EXTERN_ long start_frame, end_frame;    /* Range to encode in source framerate units */
-EXTERN_ int seq_header_every_gop;
-
-/* coding model parameters */
-
-EXTERN_ int N; /* number of frames in Group of Pictures */
-EXTERN_ int M; /* distance between I/P frames */
-EXTERN_ int P; /* intra slice refresh interval */
-EXTERN_ int nframes; /* total number of frames to encode */
-EXTERN_ long frames_scaled; /* frame count normalized to output frame rate */
-EXTERN_ int frame0, tc0; /* number and timecode of first frame */
-EXTERN_ int mpeg1; /* ISO/IEC IS 11172-2 sequence */
-EXTERN_ int fieldpic; /* use field pictures */
-
-/* sequence specific data (sequence header) */
-
-EXTERN_ int qsubsample_offset, 
-           fsubsample_offset,
-	       rowsums_offset,
-	       colsums_offset;		/* Offset from picture buffer start of sub-sampled data... */
-EXTERN_ int mb_per_pict;			/* Number of macro-blocks in a picture */						      
-EXTERN_ int fast_mc_frac;	 /* inverse proportion of fast motion estimates
-			 				 consider in detail */
-EXTERN_ int mc_44_red;			/* Sub-mean population reduction passes for 4x4 and 2x2 */
-EXTERN_ int mc_22_red;			/* Motion compensation stages						*/
-
-
-
-EXTERN_ int horizontal_size, vertical_size; /* frame size (pels) */
-EXTERN_ int width, height; /* encoded frame size (pels) multiples of 16 or 32 */
-EXTERN_ int chrom_width, chrom_height, block_count;
-EXTERN_ int mb_width, mb_height; /* frame size (macroblocks) */
-EXTERN_ int width2, height2, mb_height2, chrom_width2; /* picture size adjusted for interlacing */
-EXTERN_ int aspectratio; /* aspect ratio information (pel or display) */
-EXTERN_ int frame_rate_code; /* coded value of frame rate */
-EXTERN_ int dctsatlim;			/* Value to saturated DCT coeffs to */
-EXTERN_ double frame_rate; /* frames per second */
-EXTERN_ double input_frame_rate; /* input frame rate */
-EXTERN_ double bit_rate; /* bits per second */
-EXTERN_ int video_buffer_size;
-EXTERN_ int vbv_buffer_size; /* size of VBV buffer (* 16 kbit) */
-EXTERN_ int constrparms; /* constrained parameters flag (MPEG-1 only) */
-EXTERN_ int load_iquant, load_niquant; /* use non-default quant. matrices */
-EXTERN_ int load_ciquant,load_cniquant;
-
-
-/* sequence specific data (sequence extension) */
-
-EXTERN_ int profile, level; /* syntax / parameter constraints */
-EXTERN_ int prog_seq; /* progressive sequence */
-EXTERN_ int chroma_format;
-EXTERN_ int low_delay; /* no B pictures, skipped pictures */
-
-
-/* sequence specific data (sequence display extension) */
-
-EXTERN_ int video_format; /* component, PAL, NTSC, SECAM or MAC */
-EXTERN_ int color_primaries; /* source primary chromaticity coordinates */
-EXTERN_ int transfer_characteristics; /* opto-electronic transfer char. (gamma) */
-EXTERN_ int matrix_coefficients; /* Eg,Eb,Er / Y,Cb,Cr matrix coefficients */
-EXTERN_ int display_horizontal_size, display_vertical_size; /* display size */
-
-
-/* picture specific data (picture coding extension) */
-EXTERN_ int opt_dc_prec;
-EXTERN_ int opt_prog_frame;
-EXTERN_ int opt_repeatfirst;
-EXTERN_ int opt_topfirst;
-
-/* use only frame prediction and frame DCT (I,P,B,current) */
-EXTERN_ int frame_pred_dct_tab[3];
-EXTERN_ int conceal_tab[3]; /* use concealment motion vectors (I,P,B) */
-EXTERN_ int qscale_tab[3]; /* linear/non-linear quantizaton table */
-EXTERN_ int intravlc_tab[3]; /* intra vlc format (I,P,B,current) */
-EXTERN_ int altscan_tab[3]; /* alternate scan (I,P,B,current) */
+
+
+/* Encoder state.  Every encoder running in the process has its own copy.
+ * The encoding thread and the engine threads reach it through
+ * mpeg2enc_current.
+ */
+typedef struct mpeg2enc_s
+{
+	pthread_mutex_t test_lock;
+	motion_engine_t *motion_engines;
+	transform_engine_t *transform_engines;
+	transform_engine_t *itransform_engines;
+	slice_engine_t *slice_engines;
+	ratectl_t **ratectl;
+	int quiet; /* suppress warnings */
+
+	pict_data_s cur_picture;
+
+	/* reconstructed frames */
+	unsigned char *newrefframe[3], *oldrefframe[3], *auxframe[3];
+	/* original frames */
+	unsigned char *neworgframe[3], *oldorgframe[3], *auxorgframe[3];
+	/* prediction of current frame */
+	unsigned char *predframe[3];
+	/* motion estimation parameters */
+	struct motion_data *motion_data;
+
+	/* Orginal intra / non_intra quantization matrices */
+	uint16_t intra_q[64], inter_q[64];
+	uint16_t i_intra_q[64], i_inter_q[64];
+
+	/* Table driven intra / non-intra quantization matrices */
+	uint16_t intra_q_tbl[113][64], inter_q_tbl[113][64];
+	uint16_t i_intra_q_tbl[113][64], i_inter_q_tbl[113][64];
+	float intra_q_tblf[113][64], inter_q_tblf[113][64];
+	float i_intra_q_tblf[113][64], i_inter_q_tblf[113][64];
+
+	uint16_t chrom_intra_q[64],chrom_inter_q[64];
+
+	/* clipping (=saturation) table */
+	unsigned char *clp;
+
+	/* name strings */
+	char id_string[256], tplorg[256], tplref[256], out_path[256];
+	char iqname[256], niqname[256];
+	char statname[256];
+	char errortext[256];
+
+	FILE *outfile; /* file descriptors */
+	FILE *statfile; /* file descriptors */
+	int inputtype; /* format of input frames */
+
+	uint8_t ***frame_buffers;
+
+	/* These determine what input format to use */
+	quicktime_t *qt_file;
+	mpeg3_t *mpeg_file;
+	int do_stdin;
+	FILE *stdin_fd;
+
+	int do_buffers;
+	pthread_mutex_t input_lock;
+	pthread_mutex_t output_lock;
+	pthread_mutex_t copy_lock;
+	char *input_buffer_y;
+	char *input_buffer_u;
+	char *input_buffer_v;
+	int input_buffer_end;
+
+	int verbose;
+	quicktime_t *qt_output;
+	unsigned char *frame_buffer;
+	unsigned char **row_pointers;
+	int fixed_mquant;
+	double quant_floor;    		/* quantisation floor [1..10] (0 for CBR) */
+	double act_boost;		/* Quantisation reduction for highly active blocks */
+	int use_hires_quant;
+	int use_denoise_quant;
+	/* Number of processors */
+	int processors;
+	long start_frame, end_frame;    /* Range to encode in source framerate units */
+	int seq_header_every_gop;
+
+	/* coding model parameters */
+
+	int N; /* number of frames in Group of Pictures */
+	int M; /* distance between I/P frames */
+	int P; /* intra slice refresh interval */
+	int nframes; /* total number of frames to encode */
+	long frames_scaled; /* frame count normalized to output frame rate */
+	int frame0, tc0; /* number and timecode of first frame */
+	int mpeg1; /* ISO/IEC IS 11172-2 sequence */
+	int fieldpic; /* use field pictures */
+
+	/* sequence specific data (sequence header) */
+
+	int qsubsample_offset, 
+		fsubsample_offset,
+		rowsums_offset,
+		colsums_offset;		/* Offset from picture buffer start of sub-sampled data... */
+	int mb_per_pict;			/* Number of macro-blocks in a picture */
+	int fast_mc_frac;	 /* inverse proportion of fast motion estimates
+						 consider in detail */
+	int mc_44_red;			/* Sub-mean population reduction passes for 4x4 and 2x2 */
+	int mc_22_red;			/* Motion compensation stages						*/
+
+	int horizontal_size, vertical_size; /* frame size (pels) */
+	int width, height; /* encoded frame size (pels) multiples of 16 or 32 */
+	int chrom_width, chrom_height, block_count;
+	int mb_width, mb_height; /* frame size (macroblocks) */
+	int width2, height2, mb_height2, chrom_width2; /* picture size adjusted for interlacing */
+	int aspectratio; /* aspect ratio information (pel or display) */
+	int frame_rate_code; /* coded value of frame rate */
+	int dctsatlim;			/* Value to saturated DCT coeffs to */
+	double frame_rate; /* frames per second */
+	double input_frame_rate; /* input frame rate */
+	double bit_rate; /* bits per second */
+	int video_buffer_size;
+	int vbv_buffer_size; /* size of VBV buffer (* 16 kbit) */
+	int constrparms; /* constrained parameters flag (MPEG-1 only) */
+	int load_iquant, load_niquant; /* use non-default quant. matrices */
+	int load_ciquant,load_cniquant;
+
+	/* sequence specific data (sequence extension) */
+
+	int profile, level; /* syntax / parameter constraints */
+	int prog_seq; /* progressive sequence */
+	int chroma_format;
+	int low_delay; /* no B pictures, skipped pictures */
+
+	/* sequence specific data (sequence display extension) */
+
+	int video_format; /* component, PAL, NTSC, SECAM or MAC */
+	int color_primaries; /* source primary chromaticity coordinates */
+	int transfer_characteristics; /* opto-electronic transfer char. (gamma) */
+	int matrix_coefficients; /* Eg,Eb,Er / Y,Cb,Cr matrix coefficients */
+	int display_horizontal_size, display_vertical_size; /* display size */
+
+	/* picture specific data (picture coding extension) */
+	int opt_dc_prec;
+	int opt_prog_frame;
+	int opt_repeatfirst;
+	int opt_topfirst;
+
+	/* use only frame prediction and frame DCT (I,P,B,current) */
+	int frame_pred_dct_tab[3];
+	int conceal_tab[3]; /* use concealment motion vectors (I,P,B) */
+	int qscale_tab[3]; /* linear/non-linear quantizaton table */
+	int intravlc_tab[3]; /* intra vlc format (I,P,B,current) */
+	int altscan_tab[3]; /* alternate scan (I,P,B,current) */
+
+	/* putbits.c */
+	unsigned char outbfr;
+	int outcnt;
+	int bytecnt;
+
+	/* readpic.c */
+	unsigned char *u444, *v444, *u422, *v422;
+
+	/* error() unwinds the encoding thread to mpeg2enc() through error_jump */
+	pthread_t thread;
+	jmp_buf error_jump;
+	int error;
+} mpeg2enc_t;
+
+EXTERN_ __thread mpeg2enc_t *mpeg2enc_current;
+#define enc mpeg2enc_current
 
 /* prototypes of global functions */
 
@@ -593,6 +611,13 @@ void predict _ANSI_ARGS_((pict_data_s *picture,
 			 uint8_t *refb[],
 			 uint8_t *cur[3],
 			 int secondfield));
+void predict_rows _ANSI_ARGS_((pict_data_s *picture, 
+			 uint8_t *reff[],
+			 uint8_t *refb[],
+			 uint8_t *cur[3],
+			 int secondfield,
+			 int start_row,
+			 int end_row));
 
 /* putbits.c */
 void slice_initbits(slice_engine_t *engine);
@@ -646,6 +671,7 @@ extern int (*pquant_weight_coeff_sum)(int16_t *blk, uint16_t*i_quant_mat );
 /* quantize.c */
 
 void iquantize( pict_data_s *picture );
+void iquantize_rows( pict_data_s *picture, int start_row, int end_row );
 void quant_intra_hv (	pict_data_s *picture,
 					int16_t *src, int16_t *dst, 
 					int mquant, int *nonsat_mquant);
@@ -681,10 +707,15 @@ void stats _ANSI_ARGS_((void));
 
 /* transfrm.c */
 void transform _ANSI_ARGS_((pict_data_s *picture,
+				uint8_t *reff[],
+				uint8_t *refb[],
 				uint8_t *pred[], 
-				uint8_t *cur[]));
+				uint8_t *cur[],
+				int secondfield));
 void itransform _ANSI_ARGS_((pict_data_s *picture,
 				  uint8_t *pred[], uint8_t *cur[]));
 void dct_type_estimation _ANSI_ARGS_((pict_data_s *picture,
 	uint8_t *pred, uint8_t *cur));
+void dct_type_estimation_rows _ANSI_ARGS_((pict_data_s *picture,
+	uint8_t *pred, uint8_t *cur, int start_row, int end_row));
 
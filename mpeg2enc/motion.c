@@ -384,31 +384,31 @@ static void frame_estimate(motion_engine_t *engine,
 	mb_motion_s topfld_mc;
 	mb_motion_s botfld_mc;
 
-	botssmb.mb = ssmb->mb+width;
-	botssmb.fmb = ssmb->mb+(width>>1);
-	botssmb.qmb = ssmb->qmb+(width>>2);
-	botssmb.umb = ssmb->umb+(width>>1);
-	botssmb.vmb = ssmb->vmb+(width>>1);
+	botssmb.mb = ssmb->mb+enc->width;
+	botssmb.fmb = ssmb->mb+(enc->width>>1);
+	botssmb.qmb = ssmb->qmb+(enc->width>>2);
+	botssmb.umb = ssmb->umb+(enc->width>>1);
+	botssmb.vmb = ssmb->vmb+(enc->width>>1);
 
 	/* frame prediction */
-	fullsearch(engine, org,ref,ssmb,width,i,j,sx,sy,16,width,height,
+	fullsearch(engine, org,ref,ssmb,enc->width,i,j,sx,sy,16,enc->width,enc->height,
 						  bestfr );
 	bestfr->fieldsel = 0;
 	bestfr->fieldoff = 0;
 
 	/* predict top field from top field */
-	fullsearch(engine, org,ref,ssmb,width<<1,i,j>>1,sx,sy>>1,8,width,height>>1,
+	fullsearch(engine, org,ref,ssmb,enc->width<<1,i,j>>1,sx,sy>>1,8,enc->width,enc->height>>1,
 			   &topfld_mc);
 
 	/* predict top field from bottom field */
-	fullsearch(engine, org+width,ref+width,ssmb, width<<1,i,j>>1,sx,sy>>1,8,
-			   width,height>>1, &botfld_mc);
+	fullsearch(engine, org+enc->width,ref+enc->width,ssmb, enc->width<<1,i,j>>1,sx,sy>>1,8,
+			   enc->width,enc->height>>1, &botfld_mc);
 
 	/* set correct field selectors... */
 	topfld_mc.fieldsel = 0;
 	botfld_mc.fieldsel = 1;
 	topfld_mc.fieldoff = 0;
-	botfld_mc.fieldoff = width;
+	botfld_mc.fieldoff = enc->width;
 
 	imins[0][0] = topfld_mc.pos.x;
 	jmins[0][0] = topfld_mc.pos.y;
@@ -427,19 +427,19 @@ static void frame_estimate(motion_engine_t *engine,
 
 	/* predict bottom field from top field */
 	fullsearch(engine, org,ref,&botssmb,
-					width<<1,i,j>>1,sx,sy>>1,8,width,height>>1,
+					enc->width<<1,i,j>>1,sx,sy>>1,8,enc->width,enc->height>>1,
 					&topfld_mc);
 
 	/* predict bottom field from bottom field */
-	fullsearch(engine, org+width,ref+width,&botssmb,
-					width<<1,i,j>>1,sx,sy>>1,8,width,height>>1,
+	fullsearch(engine, org+enc->width,ref+enc->width,&botssmb,
+					enc->width<<1,i,j>>1,sx,sy>>1,8,enc->width,enc->height>>1,
 					&botfld_mc);
 
 	/* set correct field selectors... */
 	topfld_mc.fieldsel = 0;
 	botfld_mc.fieldsel = 1;
 	topfld_mc.fieldoff = 0;
-	botfld_mc.fieldoff = width;
+	botfld_mc.fieldoff = enc->width;
 
 	imins[0][1] = topfld_mc.pos.x;
 	jmins[0][1] = topfld_mc.pos.y;
@@ -496,11 +496,11 @@ static void field_estimate (motion_engine_t *engine,
 	int notop, nobot;
 	subsampled_mb_s botssmb;
 
-	botssmb.mb = ssmb->mb+width;
-	botssmb.umb = ssmb->umb+(width>>1);
-	botssmb.vmb = ssmb->vmb+(width>>1);
-	botssmb.fmb = ssmb->fmb+(width>>1);
-	botssmb.qmb = ssmb->qmb+(width>>2);
+	botssmb.mb = ssmb->mb+enc->width;
+	botssmb.umb = ssmb->umb+(enc->width>>1);
+	botssmb.vmb = ssmb->vmb+(enc->width>>1);
+	botssmb.fmb = ssmb->fmb+(enc->width>>1);
+	botssmb.qmb = ssmb->qmb+(enc->width>>2);
 
 	/* if ipflag is set, predict from field of opposite parity only */
 	notop = ipflag && (picture->pict_struct==TOP_FIELD);
@@ -512,23 +512,23 @@ static void field_estimate (motion_engine_t *engine,
 	if (notop)
 		topfld_mc.sad = dt = 65536; /* infinity */
 	else
-		fullsearch(engine, toporg,topref,ssmb,width<<1,
-				   i,j,sx,sy>>1,16,width,height>>1,
+		fullsearch(engine, toporg,topref,ssmb,enc->width<<1,
+				   i,j,sx,sy>>1,16,enc->width,enc->height>>1,
 				   &topfld_mc);
 	dt = topfld_mc.sad;
 	/* predict current field from bottom field */
 	if (nobot)
 		botfld_mc.sad = db = 65536; /* infinity */
 	else
-		fullsearch(engine, botorg,botref,ssmb,width<<1,
-				   i,j,sx,sy>>1,16,width,height>>1,
+		fullsearch(engine, botorg,botref,ssmb,enc->width<<1,
+				   i,j,sx,sy>>1,16,enc->width,enc->height>>1,
 				   &botfld_mc);
 	db = botfld_mc.sad;
 	/* Set correct field selectors */
 	topfld_mc.fieldsel = 0;
 	botfld_mc.fieldsel = 1;
 	topfld_mc.fieldoff = 0;
-	botfld_mc.fieldoff = width;
+	botfld_mc.fieldoff = enc->width;
 
 	/* same parity prediction (only valid if ipflag==0) */
 	if (picture->pict_struct==TOP_FIELD)
@@ -557,16 +557,16 @@ static void field_estimate (motion_engine_t *engine,
 	if (notop)
 		topfld_mc.sad = dt = 65536;
 	else
-		fullsearch(engine, toporg,topref,ssmb,width<<1,
-				   i,j,sx,sy>>1,8,width,height>>1,
+		fullsearch(engine, toporg,topref,ssmb,enc->width<<1,
+				   i,j,sx,sy>>1,8,enc->width,enc->height>>1,
 				    &topfld_mc);
 	dt = topfld_mc.sad;
 	/* predict upper half field from bottom field */
 	if (nobot)
 		botfld_mc.sad = db = 65536;
 	else
-		fullsearch(engine, botorg,botref,ssmb,width<<1,
-				   i,j,sx,sy>>1,8,width,height>>1,
+		fullsearch(engine, botorg,botref,ssmb,enc->width<<1,
+				   i,j,sx,sy>>1,8,enc->width,enc->height>>1,
 				    &botfld_mc);
 	db = botfld_mc.sad;
 
@@ -574,7 +574,7 @@ static void field_estimate (motion_engine_t *engine,
 	topfld_mc.fieldsel = 0;
 	botfld_mc.fieldsel = 1;
 	topfld_mc.fieldoff = 0;
-	botfld_mc.fieldoff = width;
+	botfld_mc.fieldoff = enc->width;
 
 	/* select prediction for upper half field */
 	if (dt<=db)
@@ -601,23 +601,23 @@ static void field_estimate (motion_engine_t *engine,
 		topfld_mc.sad = dt = 65536;
 	else
 		fullsearch(engine, toporg,topref,&botssmb,
-						width<<1,
-						i,j+8,sx,sy>>1,8,width,height>>1,
+						enc->width<<1,
+						i,j+8,sx,sy>>1,8,enc->width,enc->height>>1,
 				   /* &imint,&jmint, &dt,*/ &topfld_mc);
 	dt = topfld_mc.sad;
 	/* predict lower half field from bottom field */
 	if (nobot)
 		botfld_mc.sad = db = 65536;
 	else
-		fullsearch(engine, botorg,botref,&botssmb,width<<1,
-						i,j+8,sx,sy>>1,8,width,height>>1,
+		fullsearch(engine, botorg,botref,&botssmb,enc->width<<1,
+						i,j+8,sx,sy>>1,8,enc->width,enc->height>>1,
 				   /* &iminb,&jminb, &db,*/ &botfld_mc);
 	db = botfld_mc.sad;
 	/* Set correct field selectors */
 	topfld_mc.fieldsel = 0;
 	botfld_mc.fieldsel = 1;
 	topfld_mc.fieldoff = 0;
-	botfld_mc.fieldoff = width;
+	botfld_mc.fieldoff = enc->width;
 
 	/* select prediction for lower half field */
 	if (dt<=db)
@@ -714,8 +714,8 @@ static void dpframe_estimate (motion_engine_t *engine,
 			ib0 += i<<1;
 			jb0 += j<<1;
 
-			if (is >= 0 && is <= (width-16)<<1 &&
-				js >= 0 && js <= (height-16))
+			if (is >= 0 && is <= (enc->width-16)<<1 &&
+				js >= 0 && js <= (enc->height-16))
 			{
 				for (delta_y=-1; delta_y<=1; delta_y++)
 				{
@@ -727,24 +727,24 @@ static void dpframe_estimate (motion_engine_t *engine,
 						ib = ib0 + delta_x;
 						jb = jb0 + delta_y;
 
-						if (it >= 0 && it <= (width-16)<<1 &&
-							jt >= 0 && jt <= (height-16) &&
-							ib >= 0 && ib <= (width-16)<<1 &&
-							jb >= 0 && jb <= (height-16))
+						if (it >= 0 && it <= (enc->width-16)<<1 &&
+							jt >= 0 && jt <= (enc->height-16) &&
+							ib >= 0 && ib <= (enc->width-16)<<1 &&
+							jb >= 0 && jb <= (enc->height-16))
 						{
 							/* compute prediction error */
 							local_dist = (*pbdist2)(
-								ref + (is>>1) + (width<<1)*(js>>1),
-								ref + width + (it>>1) + (width<<1)*(jt>>1),
+								ref + (is>>1) + (enc->width<<1)*(js>>1),
+								ref + enc->width + (it>>1) + (enc->width<<1)*(jt>>1),
 								ssmb->mb,             /* current mb location */
-								width<<1,       /* adjacent line distance */
+								enc->width<<1,       /* adjacent line distance */
 								is&1, js&1, it&1, jt&1, /* half-pel flags */
 								8);             /* block height */
 							local_dist += (*pbdist2)(
-								ref + width + (is>>1) + (width<<1)*(js>>1),
-								ref + (ib>>1) + (width<<1)*(jb>>1),
-								ssmb->mb + width,     /* current mb location */
-								width<<1,       /* adjacent line distance */
+								ref + enc->width + (is>>1) + (enc->width<<1)*(js>>1),
+								ref + (ib>>1) + (enc->width<<1)*(jb>>1),
+								ssmb->mb + enc->width,     /* current mb location */
+								enc->width<<1,       /* adjacent line distance */
 								is&1, js&1, ib&1, jb&1, /* half-pel flags */
 								8);             /* block height */
 
@@ -771,18 +771,18 @@ static void dpframe_estimate (motion_engine_t *engine,
 	/* TODO: This is now likely to be obsolete... */
 	/* Compute L1 error for decision purposes */
 	local_dist = (*pbdist1)(
-		ref + (imins>>1) + (width<<1)*(jmins>>1),
-		ref + width + (imint>>1) + (width<<1)*(jmint>>1),
+		ref + (imins>>1) + (enc->width<<1)*(jmins>>1),
+		ref + enc->width + (imint>>1) + (enc->width<<1)*(jmint>>1),
 		ssmb->mb,
-		width<<1,
+		enc->width<<1,
 		imins&1, jmins&1, imint&1, jmint&1,
 		8);
 //printf("motion 1 %p\n", pbdist1);
 	local_dist += (*pbdist1)(
-		ref + width + (imins>>1) + (width<<1)*(jmins>>1),
-		ref + (iminb>>1) + (width<<1)*(jminb>>1),
-		ssmb->mb + width,
-		width<<1,
+		ref + enc->width + (imins>>1) + (enc->width<<1)*(jmins>>1),
+		ref + (iminb>>1) + (enc->width<<1)*(jminb>>1),
+		ssmb->mb + enc->width,
+		enc->width<<1,
 		imins&1, jmins&1, iminb&1, jminb&1,
 		8);
 //printf("motion 2\n");
@@ -857,15 +857,15 @@ static void dpfield_estimate(motion_engine_t *engine,
 			io = io0 + delta_x;
 			jo = jo0 + delta_y;
 
-			if (io >= 0 && io <= (width-16)<<1 &&
-				jo >= 0 && jo <= (height2-16)<<1)
+			if (io >= 0 && io <= (enc->width-16)<<1 &&
+				jo >= 0 && jo <= (enc->height2-16)<<1)
 			{
 				/* compute prediction error */
 				local_dist = (*pbdist2)(
-					sameref + (imins>>1) + width2*(jmins>>1),
-					oppref  + (io>>1)    + width2*(jo>>1),
+					sameref + (imins>>1) + enc->width2*(jmins>>1),
+					oppref  + (io>>1)    + enc->width2*(jo>>1),
 					mb,             /* current mb location */
-					width2,         /* adjacent line distance */
+					enc->width2,         /* adjacent line distance */
 					imins&1, jmins&1, io&1, jo&1, /* half-pel flags */
 					16);            /* block height */
 
@@ -885,10 +885,10 @@ static void dpfield_estimate(motion_engine_t *engine,
 	/* Compute L1 error for decision purposes */
 	bestdp_mc->sad =
 		(*pbdist1)(
-			sameref + (imins>>1) + width2*(jmins>>1),
-			oppref  + (imino>>1) + width2*(jmino>>1),
+			sameref + (imins>>1) + enc->width2*(jmins>>1),
+			oppref  + (imino>>1) + enc->width2*(jmino>>1),
 			mb,             /* current mb location */
-			width2,         /* adjacent line distance */
+			enc->width2,         /* adjacent line distance */
 			imins&1, jmins&1, imino&1, jmino&1, /* half-pel flags */
 			16);            /* block height */
 
@@ -1020,7 +1020,7 @@ static int build_sub44_mcomps(motion_engine_t *engine,
 
 	engine->sub44_num_mcomps = 0;
 	
-	threshold = 6*null_mc_sad / (4*4*mc_44_red);
+	threshold = 6*null_mc_sad / (4*4*enc->mc_44_red);
 	s44orgblk = s44org+(ilow>>2)+qlx*(jlow>>2);
 	
 	/* Exhaustive search on 4*4 sub-sampled data.  This is affordable because
@@ -1062,7 +1062,7 @@ static int build_sub44_mcomps(motion_engine_t *engine,
 #endif	
 		/* If we're really pushing quality we reduce once otherwise twice. */
 			
-		sub_mean_reduction( engine->sub44_mcomps, engine->sub44_num_mcomps, 1+(mc_44_red>1),
+		sub_mean_reduction( engine->sub44_mcomps, engine->sub44_num_mcomps, 1+(enc->mc_44_red>1),
 						    &engine->sub44_num_mcomps, &mean_weight);
 
 
@@ -1086,7 +1086,7 @@ static int build_sub22_mcomps(motion_engine_t *engine,
 		int flx, int fh,  int searched_sub44_size )
 {
 	int i,k,s;
-	int threshold = 6*null_mc_sad / (2 * 2*mc_22_red);
+	int threshold = 6*null_mc_sad / (2 * 2*enc->mc_22_red);
 
 	int min_weight;
 	int ilim = ihigh-i0;
@@ -1146,7 +1146,7 @@ int build_sub22_mcomps_mmxe(motion_engine_t *engine,
 	int flx, int fh,  int searched_sub44_size )
 {
 	int i,k,s;
-	int threshold = 6*null_mc_sad / (2 * 2*mc_22_red);
+	int threshold = 6*null_mc_sad / (2 * 2*enc->mc_22_red);
 
 	int min_weight;
 	int ilim = ihigh-i0;
@@ -1383,8 +1383,8 @@ static void fullsearch(motion_engine_t *engine,
 	   works better when the original image not the reference (reconstructed)
 	   image is used. 
 	*/
-	uint8_t *s22org = (uint8_t*)(org+fsubsample_offset);
-	uint8_t *s44org = (uint8_t*)(org+qsubsample_offset);
+	uint8_t *s22org = (uint8_t*)(org+enc->fsubsample_offset);
+	uint8_t *s44org = (uint8_t*)(org+enc->qsubsample_offset);
 	uint8_t *orgblk;
 	int flx = lx >> 1;
 	int qlx = lx >> 2;
@@ -1700,7 +1700,7 @@ void fast_motion_data(uint8_t *blk, int picture_struct )
 	uint16_t *pc, *pr,*p;
 	int rowsum;
 	int j,s;
-	int down16 = width*16;
+	int down16 = enc->width*16;
 	uint16_t sums[32];
 	uint16_t rowsums[2048];
 	uint16_t colsums[2048];  /* TODO: BUG: should resize with width */
@@ -1712,17 +1712,17 @@ void fast_motion_data(uint8_t *blk, int picture_struct )
 
 	if (picture_struct==FRAME_PICTURE)
 	{
-		nextfieldline = width;
+		nextfieldline = enc->width;
 	}
 	else
 	{
-		nextfieldline = 2*width;
+		nextfieldline = 2*enc->width;
 	}
 
-	start_s22blk   = blk+fsubsample_offset;
-	start_s44blk   = blk+qsubsample_offset;
-	start_rowblk = (uint16_t *)blk+rowsums_offset;
-	start_colblk = (uint16_t *)blk+colsums_offset;
+	start_s22blk   = blk+enc->fsubsample_offset;
+	start_s44blk   = blk+enc->qsubsample_offset;
+	start_rowblk = (uint16_t *)blk+enc->rowsums_offset;
+	start_colblk = (uint16_t *)blk+enc->colsums_offset;
 	b = blk;
 	nb = (blk+nextfieldline);
 	/* Sneaky stuff here... we can do lines in both fields at once */
@@ -1778,7 +1778,7 @@ void fast_motion_data(uint8_t *blk, int picture_struct )
 	  Initial row sums....
 	*/
 	pb = blk;
-	for(j = 0; j < height; ++j )
+	for(j = 0; j < enc->height; ++j )
 	{
 		rowsum = 0;
 		for( i = 0; i < 16; ++ i )
@@ -1786,20 +1786,20 @@ void fast_motion_data(uint8_t *blk, int picture_struct )
 			rowsum += pb[i];
 		}
 		rowsums[j] = rowsum;
-		pb += width;
+		pb += enc->width;
 	}
   
 	/*
 	  Initial column sums
 	*/
-	for( i = 0; i < width; ++i )
+	for( i = 0; i < enc->width; ++i )
 	{
 		colsums[i] = 0;
 	}
 	pb = blk;
 	for( j = 0; j < 16; ++j )
 	{
-		for( i = 0; i < width; ++i )
+		for( i = 0; i < enc->width; ++i )
 		{
 			colsums[i] += *pb;
 			++pb;
@@ -1819,17 +1819,17 @@ void fast_motion_data(uint8_t *blk, int picture_struct )
 	{
 		pr = start_rowblk;
 		rowsum = rowsums[j];
-		for( i = 0; i < width-16; ++i )
+		for( i = 0; i < enc->width-16; ++i )
 		{
 			pc[i] = colsums[i];
 			pr[j] = rowsum;
 			colsums[i] = (colsums[i] + pb[down16] )-pb[0];
 			rowsum = (rowsum + pb[16]) - pb[0];
 			++pb;
-			pr += height;
+			pr += enc->height;
 		}
 		pb += 16;   /* move pb on to next row... rememember we only did width-16! */
-		pc += width;
+		pc += enc->width;
 	}
 #endif 		
 }
@@ -2236,9 +2236,9 @@ static void frame_ME(motion_engine_t *engine,
 	ssmb.mb = mc->cur[0] + mb_row_start + i;
 	ssmb.umb = (uint8_t*)(mc->cur[1] + (i>>1) + (mb_row_start>>2));
 	ssmb.vmb = (uint8_t*)(mc->cur[2] + (i>>1) + (mb_row_start>>2));
-	ssmb.fmb = (uint8_t*)(mc->cur[0] + fsubsample_offset + 
+	ssmb.fmb = (uint8_t*)(mc->cur[0] + enc->fsubsample_offset + 
 						  ((i>>1) + (mb_row_start>>2)));
-	ssmb.qmb = (uint8_t*)(mc->cur[0] + qsubsample_offset + 
+	ssmb.qmb = (uint8_t*)(mc->cur[0] + enc->qsubsample_offset + 
 						  (i>>2) + (mb_row_start>>4));
 
 	/* Compute variance MB as a measure of Intra-coding complexity
@@ -2246,7 +2246,7 @@ static void frame_ME(motion_engine_t *engine,
 	   for sub-sampling.  Silly MPEG forcing chrom/lum to have same
 	   quantisations...
 	 */
-	var = variance(ssmb.mb,16,width);
+	var = variance(ssmb.mb,16,enc->width);
 
 //printf("motion %d\n", picture->pict_type);
 	if (picture->pict_type==I_TYPE)
@@ -2257,16 +2257,16 @@ static void frame_ME(motion_engine_t *engine,
 	{
 		/* For P pictures we take into account chrominance. This
 		   provides much better performance at scene changes */
-		var += chrom_var_sum(&ssmb,16,width);
+		var += chrom_var_sum(&ssmb,16,enc->width);
 
 		if (picture->frame_pred_dct)
 		{
 			fullsearch(engine, mc->oldorg[0],mc->oldref[0],&ssmb,
-					   width,i,j,mc->sxf,mc->syf,16,width,height,
+					   enc->width,i,j,mc->sxf,mc->syf,16,enc->width,enc->height,
 					    &framef_mc);
 			framef_mc.fieldoff = 0;
 			vmc = framef_mc.var +
-				unidir_chrom_var_sum( &framef_mc, mc->oldref, &ssmb, width, 16 );
+				unidir_chrom_var_sum( &framef_mc, mc->oldref, &ssmb, enc->width, 16 );
 			mbi->motion_type = MC_FRAME;
 		}
 		else
@@ -2286,12 +2286,12 @@ static void frame_ME(motion_engine_t *engine,
 				jmins);
 //printf("frame_ME 3\n");
 			vmcf = framef_mc.var + 
-				unidir_chrom_var_sum( &framef_mc, mc->oldref, &ssmb, width, 16 );
+				unidir_chrom_var_sum( &framef_mc, mc->oldref, &ssmb, enc->width, 16 );
 			vmcfieldf = 
 				topfldf_mc.var + 
-				unidir_chrom_var_sum( &topfldf_mc, mc->oldref, &ssmb, (width<<1), 8 ) +
+				unidir_chrom_var_sum( &topfldf_mc, mc->oldref, &ssmb, (enc->width<<1), 8 ) +
 				botfldf_mc.var + 
-				unidir_chrom_var_sum( &botfldf_mc, mc->oldref, &ssmb, (width<<1), 8 );
+				unidir_chrom_var_sum( &botfldf_mc, mc->oldref, &ssmb, (enc->width<<1), 8 );
 			/* DEBUG DP currently disabled... */
 //			if ( M==1)
 //			{
@@ -2357,7 +2357,7 @@ static void frame_ME(motion_engine_t *engine,
 			 * blocks with small prediction error are always coded as No-MC
 			 * (requires no motion vectors, allows skipping)
 			 */
-			v0 = (*pdist2)(mc->oldref[0]+i+width*j,ssmb.mb,width,0,0,16);
+			v0 = (*pdist2)(mc->oldref[0]+i+enc->width*j,ssmb.mb,enc->width,0,0,16);
 
 			if (4*v0>5*vmc )
 			{
@@ -2407,11 +2407,11 @@ static void frame_ME(motion_engine_t *engine,
 	{
 		if (picture->frame_pred_dct)
 		{
-			var = variance(ssmb.mb,16,width);
+			var = variance(ssmb.mb,16,enc->width);
 			/* forward */
 			fullsearch(engine, mc->oldorg[0],mc->oldref[0],&ssmb,
-					   width,i,j,mc->sxf,mc->syf,
-					   16,width,height,
+					   enc->width,i,j,mc->sxf,mc->syf,
+					   16,enc->width,enc->height,
 					   &framef_mc
 					   );
 			framef_mc.fieldoff = 0;
@@ -2419,15 +2419,15 @@ static void frame_ME(motion_engine_t *engine,
 
 			/* backward */
 			fullsearch(engine, mc->neworg[0],mc->newref[0],&ssmb,
-					   width,i,j,mc->sxb,mc->syb,
-					   16,width,height,
+					   enc->width,i,j,mc->sxb,mc->syb,
+					   16,enc->width,enc->height,
 					   &frameb_mc);
 			frameb_mc.fieldoff = 0;
 			vmcr = frameb_mc.var;
 
 			/* interpolated (bidirectional) */
 
-			vmci = bidir_pred_var( &framef_mc, &frameb_mc, ssmb.mb, width, 16 );
+			vmci = bidir_pred_var( &framef_mc, &frameb_mc, ssmb.mb, enc->width, 16 );
 
 			/* decisions */
 
@@ -2473,14 +2473,14 @@ static void frame_ME(motion_engine_t *engine,
 
 			vmcf = framef_mc.var;
 			vmcr = frameb_mc.var;
-			vmci = bidir_pred_var( &framef_mc, &frameb_mc, ssmb.mb, width, 16 );
+			vmci = bidir_pred_var( &framef_mc, &frameb_mc, ssmb.mb, enc->width, 16 );
 
 			vmcfieldf = topfldf_mc.var + botfldf_mc.var;
 			vmcfieldr = topfldb_mc.var + botfldb_mc.var;
 			vmcfieldi = bidir_pred_var( &topfldf_mc, &topfldb_mc, ssmb.mb, 
-										width<<1, 8) +
+										enc->width<<1, 8) +
 				        bidir_pred_var( &botfldf_mc, &botfldb_mc, ssmb.mb, 
-										width<<1, 8);
+										enc->width<<1, 8);
 
 			/* select prediction type of minimum distance from the
 			 * six candidates (field/frame * forward/backward/interpolated)
@@ -2625,26 +2625,26 @@ static void field_ME(motion_engine_t *engine,
 	int dmc8f,dmc8r;
 	int vmc_dp,dmc_dp;
 
-	w2 = width<<1;
+	w2 = enc->width<<1;
 
 	/* Fast motion data sits at the end of the luminance buffer */
 	ssmb.mb = mc->cur[0] + i + w2*j;
 	ssmb.umb = mc->cur[1] + ((i>>1)+(w2>>1)*(j>>1));
 	ssmb.vmb = mc->cur[2] + ((i>>1)+(w2>>1)*(j>>1));
-	ssmb.fmb = mc->cur[0] + fsubsample_offset+((i>>1)+(w2>>1)*(j>>1));
-	ssmb.qmb = mc->cur[0] + qsubsample_offset+ (i>>2)+(w2>>2)*(j>>2);
+	ssmb.fmb = mc->cur[0] + enc->fsubsample_offset+((i>>1)+(w2>>1)*(j>>1));
+	ssmb.qmb = mc->cur[0] + enc->qsubsample_offset+ (i>>2)+(w2>>2)*(j>>2);
 
 	if (picture->pict_struct==BOTTOM_FIELD)
 	{
-		ssmb.mb += width;
-		ssmb.umb += (width >> 1);
-		ssmb.vmb += (width >> 1);
-		ssmb.fmb += (width >> 1);
-		ssmb.qmb += (width >> 2);
+		ssmb.mb += enc->width;
+		ssmb.umb += (enc->width >> 1);
+		ssmb.vmb += (enc->width >> 1);
+		ssmb.fmb += (enc->width >> 1);
+		ssmb.qmb += (enc->width >> 2);
 	}
 
 	var = variance(ssmb.mb,16,w2) + 
-		( variance(ssmb.umb,8,(width>>1)) + variance(ssmb.vmb,8,(width>>1)))*2;
+		( variance(ssmb.umb,8,(enc->width>>1)) + variance(ssmb.vmb,8,(enc->width>>1)))*2;
 
 	if (picture->pict_type==I_TYPE)
 		mbi->mb_type = MB_INTRA;
@@ -2652,8 +2652,8 @@ static void field_ME(motion_engine_t *engine,
 	{
 		toporg = mc->oldorg[0];
 		topref = mc->oldref[0];
-		botorg = mc->oldorg[0] + width;
-		botref = mc->oldref[0] + width;
+		botorg = mc->oldorg[0] + enc->width;
+		botref = mc->oldref[0] + enc->width;
 
 		if (secondfield)
 		{
@@ -2661,8 +2661,8 @@ static void field_ME(motion_engine_t *engine,
 			if (picture->pict_struct==TOP_FIELD)
 			{
 				/* current is top field */
-				botorg = mc->cur[0] + width;
-				botref = mc->curref[0] + width;
+				botorg = mc->cur[0] + enc->width;
+				botref = mc->curref[0] + enc->width;
 			}
 			else
 			{
@@ -2778,7 +2778,7 @@ static void field_ME(motion_engine_t *engine,
 		field_estimate(engine, 
 						picture,
 					   mc->oldorg[0],mc->oldref[0],
-					   mc->oldorg[0]+width,mc->oldref[0]+width,&ssmb,
+					   mc->oldorg[0]+enc->width,mc->oldref[0]+enc->width,&ssmb,
 					   i,j,mc->sxf,mc->syf,0,
 					   &fieldf_mc,
 					   &field8uf_mc,
@@ -2790,7 +2790,7 @@ static void field_ME(motion_engine_t *engine,
 		/* backward prediction */
 		field_estimate(engine,
 						picture,
-					   mc->neworg[0],mc->newref[0],mc->neworg[0]+width,mc->newref[0]+width,
+					   mc->neworg[0],mc->newref[0],mc->neworg[0]+enc->width,mc->newref[0]+enc->width,
 					   &ssmb,
 					   i,j,mc->sxb,mc->syb,0,
 					   &fieldb_mc,
@@ -2915,7 +2915,7 @@ void init_motion()
 {
 	int cpucap = cpu_accel();
 
-	if( cpucap  == 0 )	/* No MMX/SSE etc support available */
+	if( !(cpucap & ACCEL_X86_MMX) )	/* No MMX support available */
 	{
 		pdist22 = dist22;
 		pdist44 = dist44;
@@ -2934,7 +2934,7 @@ void init_motion()
 #ifdef X86_CPU
 	else if(cpucap & ACCEL_X86_MMXEXT ) /* AMD MMX or SSE... */
 	{
-		if(verbose) fprintf( stderr, "SETTING EXTENDED MMX for MOTION!\n");
+		if(enc->verbose) fprintf( stderr, "SETTING EXTENDED MMX for MOTION!\n");
 		pdist22 = dist22_mmxe;
 		pdist44 = dist44_mmxe;
 		pdist1_00 = dist1_00_mmxe;
@@ -2953,7 +2953,7 @@ void init_motion()
 	}
 	else if(cpucap & ACCEL_X86_MMX) /* Ordinary MMX CPU */
 	{
-		if(verbose) fprintf( stderr, "SETTING MMX for MOTION!\n");
+		if(enc->verbose) fprintf( stderr, "SETTING MMX for MOTION!\n");
 		pdist22 = dist22_mmx;
 		pdist44 = dist44_mmx;
 		pdist1_00 = dist1_00_mmx;
@@ -2970,11 +2970,26 @@ void init_motion()
 		pmblock_sub44_dists = mblock_sub44_dists_mmx;
 	}
 #endif
+
+#ifdef __SSE2__
+/* Replace the 16 pixel wide kernels of whichever set was chosen */
+	if(cpucap & ACCEL_X86_SSE2)
+	{
+		if(enc->verbose) fprintf( stderr, "SETTING SSE2 for MOTION!\n");
+		pdist1_00 = dist1_00_sse2;
+		pdist1_01 = dist1_01_sse2;
+		pdist1_10 = dist1_10_sse2;
+		pdist1_11 = dist1_11_sse2;
+		pdist2 = dist2_sse2;
+		pbdist1 = bdist1_sse2;
+	}
+#endif
 }
 
 
 void motion_engine_loop(motion_engine_t *engine)
 {
+	enc = engine->encoder;
 	while(!engine->done)
 	{
 		pthread_mutex_lock(&(engine->input_lock));
@@ -2985,19 +3000,19 @@ void motion_engine_loop(motion_engine_t *engine)
 			motion_comp_s *mc_data = engine->motion_comp;
 			int secondfield = engine->secondfield;
 			int ipflag = engine->ipflag;
-			mbinfo_s *mbi = picture->mbinfo	+ (engine->start_row / 16) * (width / 16);
+			mbinfo_s *mbi = picture->mbinfo	+ (engine->start_row / 16) * (enc->width / 16);
 			int i, j;
 			int mb_row_incr;			/* Offset increment to go down 1 row of mb's */
 			int mb_row_start;
 
 			if (picture->pict_struct == FRAME_PICTURE)
 			{			
-				mb_row_incr = 16*width;
+				mb_row_incr = 16*enc->width;
 				mb_row_start = engine->start_row / 16 * mb_row_incr;
 /* loop through all macroblocks of a frame picture */
 				for (j=engine->start_row; j < engine->end_row; j+=16)
 				{
-					for (i=0; i<width; i+=16)
+					for (i=0; i<enc->width; i+=16)
 					{
 						frame_ME(engine, picture, mc_data, mb_row_start, i,j, mbi);
 						mbi++;
@@ -3007,12 +3022,12 @@ void motion_engine_loop(motion_engine_t *engine)
 			}
 			else
 			{		
-				mb_row_incr = (16 * 2) * width;
+				mb_row_incr = (16 * 2) * enc->width;
 				mb_row_start = engine->start_row / 16 * mb_row_incr;
 /* loop through all macroblocks of a field picture */
 				for (j=engine->start_row; j < engine->end_row; j+=16)
 				{
-					for (i=0; i<width; i+=16)
+					for (i=0; i<enc->width; i+=16)
 					{
 						field_ME(engine, picture, mc_data, mb_row_start, i,j,
 								 mbi,secondfield,ipflag);
@@ -3034,65 +3049,67 @@ void motion_estimation(pict_data_s *picture,
 {
 	int i;
 /* Start loop */
-	for(i = 0; i < processors; i++)
+	for(i = 0; i < enc->processors; i++)
 	{
-		motion_engines[i].motion_comp = mc_data;
+		enc->motion_engines[i].motion_comp = mc_data;
 
-		motion_engines[i].pict_data = picture;
+		enc->motion_engines[i].pict_data = picture;
 
-		motion_engines[i].secondfield = secondfield;
-		motion_engines[i].ipflag = ipflag;
-		pthread_mutex_unlock(&(motion_engines[i].input_lock));
+		enc->motion_engines[i].secondfield = secondfield;
+		enc->motion_engines[i].ipflag = ipflag;
+		pthread_mutex_unlock(&(enc->motion_engines[i].input_lock));
 	}
 
 /* Wait for completion */
-	for(i = 0; i < processors; i++)
+	for(i = 0; i < enc->processors; i++)
 	{
-		pthread_mutex_lock(&(motion_engines[i].output_lock));
+		pthread_mutex_lock(&(enc->motion_engines[i].output_lock));
 	}
 }
 
 void start_motion_engines()
 {
 	int i;
-	int rows_per_processor = (int)((float)height2 / 16 / processors + 0.5);
+	int rows_per_processor = (int)((float)enc->height2 / 16 / enc->processors + 0.5);
 	int current_row = 0;
 	pthread_attr_t  attr;
 	pthread_mutexattr_t mutex_attr;
 
 	pthread_mutexattr_init(&mutex_attr);
 	pthread_attr_init(&attr);
-	motion_engines = calloc(1, sizeof(motion_engine_t) * processors);
-	for(i = 0; i < processors; i++)
+	enc->motion_engines = calloc(1, sizeof(motion_engine_t) * enc->processors);
+	for(i = 0; i < enc->processors; i++)
 	{
-		motion_engines[i].start_row = current_row * i * 16;
+		enc->motion_engines[i].start_row = current_row * 16;
 		current_row += rows_per_processor;
-		if(current_row > height2 / 16) current_row = height2 / 16;
-		motion_engines[i].end_row = current_row * 16;
-		pthread_mutex_init(&(motion_engines[i].input_lock), &mutex_attr);
-		pthread_mutex_lock(&(motion_engines[i].input_lock));
-		pthread_mutex_init(&(motion_engines[i].output_lock), &mutex_attr);
-		pthread_mutex_lock(&(motion_engines[i].output_lock));
-		motion_engines[i].done = 0;
-		pthread_create(&(motion_engines[i].tid), 
+		if(current_row > enc->height2 / 16 || 
+			i == enc->processors - 1) current_row = enc->height2 / 16;
+		enc->motion_engines[i].end_row = current_row * 16;
+		pthread_mutex_init(&(enc->motion_engines[i].input_lock), &mutex_attr);
+		pthread_mutex_lock(&(enc->motion_engines[i].input_lock));
+		pthread_mutex_init(&(enc->motion_engines[i].output_lock), &mutex_attr);
+		pthread_mutex_lock(&(enc->motion_engines[i].output_lock));
+		enc->motion_engines[i].done = 0;
+		enc->motion_engines[i].encoder = enc;
+		pthread_create(&(enc->motion_engines[i].tid), 
 			&attr, 
 			(void*)motion_engine_loop, 
-			&motion_engines[i]);
+			&enc->motion_engines[i]);
 	}
 }
 
 void stop_motion_engines()
 {
 	int i;
-	for(i = 0; i < processors; i++)
+	for(i = 0; i < enc->processors; i++)
 	{
-		motion_engines[i].done = 1;
-		pthread_mutex_unlock(&(motion_engines[i].input_lock));
-		pthread_join(motion_engines[i].tid, 0);
-		pthread_mutex_destroy(&(motion_engines[i].input_lock));
-		pthread_mutex_destroy(&(motion_engines[i].output_lock));
+		enc->motion_engines[i].done = 1;
+		pthread_mutex_unlock(&(enc->motion_engines[i].input_lock));
+		pthread_join(enc->motion_engines[i].tid, 0);
+		pthread_mutex_destroy(&(enc->motion_engines[i].input_lock));
+		pthread_mutex_destroy(&(enc->motion_engines[i].output_lock));
 	}
-	free(motion_engines);
+	free(enc->motion_engines);
 }
 
 
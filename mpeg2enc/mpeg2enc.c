@@ -39,6 +39,7 @@
 
 /* private prototypes */
 static void init _ANSI_ARGS_((void));
+static void finish _ANSI_ARGS_((void));
 static void readcmdline _ANSI_ARGS_((int argc, char *argv[]));
 static void readquantmat _ANSI_ARGS_((void));
 
@@ -62,49 +63,131 @@ g_logv (const char    *log_domain,
 }
 
 
-void mpeg2enc_set_w(int width)
+mpeg2enc_t* mpeg2enc_new()
 {
-	horizontal_size = width;
+	return calloc(1, sizeof(mpeg2enc_t));
 }
 
-void mpeg2enc_set_h(int height)
+void mpeg2enc_delete(mpeg2enc_t *encoder)
 {
-	vertical_size = height;
+	int i, n;
+
+	if(encoder->clp) free(encoder->clp - 384);
+
+	if(encoder->frame_buffers)
+	{
+		for(n = 0; n < 2 * READ_LOOK_AHEAD; n++)
+		{
+			if(encoder->frame_buffers[n])
+			{
+				for(i = 0; i < 3; i++)
+					free(encoder->frame_buffers[n][i]);
+				free(encoder->frame_buffers[n]);
+			}
+		}
+		free(encoder->frame_buffers);
+	}
+
+	for(i = 0; i < 3; i++)
+	{
+		free(encoder->newrefframe[i]);
+		free(encoder->oldrefframe[i]);
+		free(encoder->auxframe[i]);
+		free(encoder->predframe[i]);
+	}
+
+	free(encoder->cur_picture.qblocks);
+	free(encoder->cur_picture.mbinfo);
+	free(encoder->cur_picture.blocks);
+
+	if(encoder->ratectl)
+	{
+		for(i = 0; i < encoder->processors; i++)
+			free(encoder->ratectl[i]);
+		free(encoder->ratectl);
+	}
+
+	free(encoder->motion_data);
+	free(encoder->frame_buffer);
+	free(encoder->row_pointers);
+	if(encoder->chroma_format != CHROMA444)
+	{
+		free(encoder->u444);
+		free(encoder->v444);
+		free(encoder->u422);
+		free(encoder->v422);
+	}
+
+	pthread_mutex_destroy(&encoder->test_lock);
+	pthread_mutex_destroy(&encoder->input_lock);
+	pthread_mutex_destroy(&encoder->output_lock);
+	pthread_mutex_destroy(&encoder->copy_lock);
+	free(encoder);
+}
+
+void mpeg2enc_set_w(mpeg2enc_t *encoder, int width)
+{
+	encoder->horizontal_size = width;
+}
+
+void mpeg2enc_set_h(mpeg2enc_t *encoder, int height)
+{
+	encoder->vertical_size = height;
 }
 
-void mpeg2enc_set_rate(double rate)
+void mpeg2enc_set_rate(mpeg2enc_t *encoder, double rate)
 {
-	input_frame_rate = rate;
+	encoder->input_frame_rate = rate;
 }
 
-void mpeg2enc_set_input_buffers(int eof, char *y, char *u, char *v)
+int mpeg2enc_set_input_buffers(mpeg2enc_t *encoder, 
+	int eof, 
+	char *y, 
+	char *u, 
+	char *v)
 {
-	pthread_mutex_lock(&output_lock);
-	input_buffer_end = eof;
-	input_buffer_y = y;
-	input_buffer_u = u;
-	input_buffer_v = v;
-	pthread_mutex_unlock(&input_lock);
+	pthread_mutex_lock(&encoder->output_lock);
+// Encoder gave up.  Nothing is going to read the buffers.
+	if(encoder->error)
+	{
+		pthread_mutex_unlock(&encoder->output_lock);
+		return 1;
+	}
+	encoder->input_buffer_end = eof;
+	encoder->input_buffer_y = y;
+	encoder->input_buffer_u = u;
+	encoder->input_buffer_v = v;
+	pthread_mutex_unlock(&encoder->input_lock);
 // Wait for buffers to get copied before returning.
-	pthread_mutex_lock(&copy_lock);
+	pthread_mutex_lock(&encoder->copy_lock);
+	return encoder->error;
 }
 
-void mpeg2enc_init_buffers()
+void mpeg2enc_init_buffers(mpeg2enc_t *encoder)
 {
-	pthread_mutex_init(&input_lock, 0);
-	pthread_mutex_init(&output_lock, 0);
-	pthread_mutex_init(&copy_lock, 0);
-	pthread_mutex_lock(&input_lock);
-	pthread_mutex_lock(&copy_lock);
-	input_buffer_end = 0;
+	pthread_mutex_init(&encoder->input_lock, 0);
+	pthread_mutex_init(&encoder->output_lock, 0);
+	pthread_mutex_init(&encoder->copy_lock, 0);
+	pthread_mutex_lock(&encoder->input_lock);
+	pthread_mutex_lock(&encoder->copy_lock);
+	encoder->input_buffer_end = 0;
 }
 
-int mpeg2enc(int argc, char *argv[])
+int mpeg2enc(mpeg2enc_t *encoder, int argc, char *argv[])
 {
-	stdin_fd = stdin;
+	enc = encoder;
+	enc->stdin_fd = stdin;
+	enc->thread = pthread_self();
+	enc->error = 0;
 	
-	verbose = 1;
+	enc->verbose = 1;
 
+/* error() jumps back here */
+	if(setjmp(enc->error_jump))
+	{
+		finish();
+		return 1;
+	}
 
 /* Read command line */
 	readcmdline(argc, argv);
@@ -112,43 +195,65 @@ int mpeg2enc(int argc, char *argv[])
 /* read quantization matrices */
 	readquantmat();
 
-	if(!strlen(out_path))
+	if(!strlen(enc->out_path))
 	{
-		fprintf(stderr, "No output file given.\n");
+		error("No output file given.");
 	}
 
 /* open output file */
-	if(!(outfile = fopen(out_path, "wb")))
+	if(!(enc->outfile = fopen(enc->out_path, "wb")))
 	{
-      sprintf(errortext,"Couldn't create output file %s", out_path);
-      error(errortext);
+      sprintf(enc->errortext,"Couldn't create output file %s", enc->out_path);
+      error(enc->errortext);
 	}
 
 	init();
 
-	if(nframes < 0x7fffffff)
+	if(enc->nframes < 0x7fffffff)
 		printf("Frame    Completion    Current bitrate     Predicted file size\n");
 	putseq();
 
-	stop_slice_engines();
-	stop_motion_engines();
-  	stop_transform_engines();
-  	stop_itransform_engines();
-
-	fclose(outfile);
-	fclose(statfile);
+	finish();
+	return enc->error;
+}
 
-	if(qt_file) quicktime_close(qt_file);
-	if(qt_output) quicktime_close(qt_output);
-	if(mpeg_file) mpeg3_close(mpeg_file);
+/* Stop the engines and close the files.  The buffers are freed by 
+   mpeg2enc_delete. */
+static void finish()
+{
+	if(enc->slice_engines) stop_slice_engines();
+	if(enc->motion_engines) stop_motion_engines();
+	if(enc->transform_engines) stop_transform_engines();
+	if(enc->itransform_engines) stop_itransform_engines();
+	enc->slice_engines = 0;
+	enc->motion_engines = 0;
+	enc->transform_engines = 0;
+	enc->itransform_engines = 0;
+
+	if(enc->outfile) fclose(enc->outfile);
+	if(enc->statfile && enc->statfile != stdout) fclose(enc->statfile);
+	enc->outfile = 0;
+	enc->statfile = 0;
+
+	if(enc->qt_file) quicktime_close(enc->qt_file);
+	if(enc->qt_output) quicktime_close(enc->qt_output);
+	if(enc->mpeg_file) mpeg3_close(enc->mpeg_file);
+	enc->qt_file = 0;
+	enc->qt_output = 0;
+	enc->mpeg_file = 0;
+
+	if(enc->do_stdin)
+	{
+		fclose(enc->stdin_fd);
+		enc->do_stdin = 0;
+	}
 
-	if(do_stdin)
+/* Release a writer waiting in mpeg2enc_set_input_buffers */
+	if(enc->error)
 	{
-		fclose(stdin_fd);
+		pthread_mutex_unlock(&enc->copy_lock);
+		pthread_mutex_unlock(&enc->output_lock);
 	}
-	pthread_mutex_destroy(&input_lock);
-	pthread_mutex_destroy(&output_lock);
-	return 0;
 }
 
 int HorzMotionCode(int i)
@@ -159,15 +264,15 @@ int HorzMotionCode(int i)
       return 2;
 	if (i < 32)
       return 3;
-	if ((i < 64) || (constrparms))
+	if ((i < 64) || (enc->constrparms))
       return 4;
 	if (i < 128)
       return 5;
 	if (i < 256)
       return 6;
-	if ((i < 512) || (level == 10))
+	if ((i < 512) || (enc->level == 10))
       return 7;
-	if ((i < 1024) || (level == 8))
+	if ((i < 1024) || (enc->level == 8))
       return 8;
 	if (i < 2048)
       return 9;
@@ -182,7 +287,7 @@ int VertMotionCode(int i)
       return 2;
 	if (i < 32)
       return 3;
-	if ((i < 64) || (level == 10) || (constrparms))
+	if ((i < 64) || (enc->level == 10) || (enc->constrparms))
       return 4;
 	return 5;
 }
@@ -190,22 +295,31 @@ int VertMotionCode(int i)
 /*
 	Wrapper for malloc that allocates pbuffers aligned to the 
 	specified byte boundary and checks for failure.
-	N.b.  don't try to free the resulting pointers, eh...
-	BUG: 	Of course this won't work if a char * won't fit in an int....
+	The result is released with free().
 */
 static uint8_t *bufalloc( size_t size )
 {
-	char *buf = malloc( size + BUFFER_ALIGN );
-	int adjust;
+	void *buf = 0;
 
-	if( buf == NULL )
+	if( posix_memalign( &buf, BUFFER_ALIGN, size ) )
 	{
 		error("malloc failed\n");
 	}
-	adjust = BUFFER_ALIGN-((intptr_t)buf)%BUFFER_ALIGN;
-	if( adjust == BUFFER_ALIGN )
-		adjust = 0;
-	return (uint8_t*)(buf+adjust);
+	return (uint8_t*)buf;
+}
+
+/* The kernel dispatch tables and the idct clipping table only depend on */
+/* the CPU, so every encoder shares one copy. */
+static pthread_once_t init_tables_once = PTHREAD_ONCE_INIT;
+
+static void init_tables()
+{
+	init_fdct();
+	init_idct();
+	init_motion();
+	init_predict_hv();
+	init_quantizer_hv();
+	init_transform_hv();
 }
 
 static void init()
@@ -215,70 +329,67 @@ static void init()
 	int lum_buffer_size, chrom_buffer_size;
 	pthread_mutexattr_t mutex_attr;
 	pthread_mutexattr_init(&mutex_attr);
-	pthread_mutex_init(&test_lock, &mutex_attr);
+	pthread_mutex_init(&enc->test_lock, &mutex_attr);
 
-	bzero(&cur_picture, sizeof(pict_data_s));
+	bzero(&enc->cur_picture, sizeof(pict_data_s));
 	mpeg2_initbits();
-	init_fdct();
-	init_idct();
-	init_motion();
-	init_predict_hv();
-	init_quantizer_hv();
-	init_transform_hv();
+	pthread_once(&init_tables_once, init_tables);
 
 /* round picture dimensions to nZearest multiple of 16 or 32 */
-	mb_width = (horizontal_size+15)/16;
-	mb_height = prog_seq ? 
-		(vertical_size + 15) / 16 : 
-		2 * ((vertical_size + 31) / 32);
-	mb_height2 = fieldpic ? 
-		mb_height >> 1 : 
-		mb_height; /* for field pictures */
-	width = 16 * mb_width;
-	height = 16 * mb_height;
+	enc->mb_width = (enc->horizontal_size+15)/16;
+	enc->mb_height = enc->prog_seq ? 
+		(enc->vertical_size + 15) / 16 : 
+		2 * ((enc->vertical_size + 31) / 32);
+	enc->mb_height2 = enc->fieldpic ? 
+		enc->mb_height >> 1 : 
+		enc->mb_height; /* for field pictures */
+	enc->width = 16 * enc->mb_width;
+	enc->height = 16 * enc->mb_height;
 
-	chrom_width = (chroma_format==CHROMA444) ? width : width>>1;
-	chrom_height = (chroma_format!=CHROMA420) ? height : height>>1;
+	enc->chrom_width = (enc->chroma_format==CHROMA444) ? enc->width : enc->width>>1;
+	enc->chrom_height = (enc->chroma_format!=CHROMA420) ? enc->height : enc->height>>1;
 
-	height2 = fieldpic ? height>>1 : height;
-	width2 = fieldpic ? width<<1 : width;
-	chrom_width2 = fieldpic ? chrom_width<<1 : chrom_width;
+	enc->height2 = enc->fieldpic ? enc->height>>1 : enc->height;
+	enc->width2 = enc->fieldpic ? enc->width<<1 : enc->width;
+	enc->chrom_width2 = enc->fieldpic ? enc->chrom_width<<1 : enc->chrom_width;
 
-	block_count = block_count_tab[chroma_format-1];
-	lum_buffer_size = (width*height) + 
-					 sizeof(uint8_t) *(width/2)*(height/2) +
-					 sizeof(uint8_t) *(width/4)*(height/4+1);
-	chrom_buffer_size = chrom_width*chrom_height;
+	enc->block_count = block_count_tab[enc->chroma_format-1];
+	lum_buffer_size = (enc->width*enc->height) + 
+					 sizeof(uint8_t) *(enc->width/2)*(enc->height/2) +
+					 sizeof(uint8_t) *(enc->width/4)*(enc->height/4+1);
+	chrom_buffer_size = enc->chrom_width*enc->chrom_height;
 
-	fsubsample_offset = (width)*(height) * sizeof(uint8_t);
-	qsubsample_offset =  fsubsample_offset + (width/2)*(height/2)*sizeof(uint8_t);
+	enc->fsubsample_offset = (enc->width)*(enc->height) * sizeof(uint8_t);
+	enc->qsubsample_offset =  enc->fsubsample_offset + (enc->width/2)*(enc->height/2)*sizeof(uint8_t);
 
-	rowsums_offset = 0;
-	colsums_offset = 0;
+	enc->rowsums_offset = 0;
+	enc->colsums_offset = 0;
 
-	mb_per_pict = mb_width*mb_height2;
+	enc->mb_per_pict = enc->mb_width*enc->mb_height2;
 
 /* clip table */
-	if (!(clp = (unsigned char *)malloc(1024)))
+	if (!(enc->clp = (unsigned char *)malloc(1024)))
       error("malloc failed\n");
-	clp+= 384;
+	enc->clp+= 384;
 	for (i=-384; i<640; i++)
-      clp[i] = (i<0) ? 0 : ((i>255) ? 255 : i);
+      enc->clp[i] = (i<0) ? 0 : ((i>255) ? 255 : i);
 
 
 	
 	/* Allocate the frame buffer */
 
 
-	frame_buffers = (uint8_t ***) 
+	enc->frame_buffers = (uint8_t ***) 
 		bufalloc(2*READ_LOOK_AHEAD*sizeof(uint8_t**));
+	bzero(enc->frame_buffers, 2*READ_LOOK_AHEAD*sizeof(uint8_t**));
 	
 	for(n=0;n<2*READ_LOOK_AHEAD;n++)
 	{
-         frame_buffers[n] = (uint8_t **) bufalloc(3*sizeof(uint8_t*));
+         enc->frame_buffers[n] = (uint8_t **) bufalloc(3*sizeof(uint8_t*));
+		 bzero(enc->frame_buffers[n], 3*sizeof(uint8_t*));
 		 for (i=0; i<3; i++)
 		 {
-			 frame_buffers[n][i] = 
+			 enc->frame_buffers[n][i] = 
 				 bufalloc( (i==0) ? lum_buffer_size : chrom_buffer_size );
 		 }
 	}
@@ -289,38 +400,38 @@ static void init()
 	for( i = 0 ; i<3; i++)
 	{
 		int size =  (i==0) ? lum_buffer_size : chrom_buffer_size;
-		newrefframe[i] = bufalloc(size);
-		oldrefframe[i] = bufalloc(size);
-		auxframe[i]    = bufalloc(size);
-		predframe[i]   = bufalloc(size);
+		enc->newrefframe[i] = bufalloc(size);
+		enc->oldrefframe[i] = bufalloc(size);
+		enc->auxframe[i]    = bufalloc(size);
+		enc->predframe[i]   = bufalloc(size);
 	}
 
-	cur_picture.qblocks =
-		(int16_t (*)[64])bufalloc(mb_per_pict*block_count*sizeof(int16_t [64]));
+	enc->cur_picture.qblocks =
+		(int16_t (*)[64])bufalloc(enc->mb_per_pict*enc->block_count*sizeof(int16_t [64]));
 
 	/* Initialise current transformed picture data tables
 	   These will soon become a buffer for transformed picture data to allow
 	   look-ahead for bit allocation etc.
 	 */
-	cur_picture.mbinfo = (
-		struct mbinfo *)bufalloc(mb_per_pict*sizeof(struct mbinfo));
+	enc->cur_picture.mbinfo = (
+		struct mbinfo *)bufalloc(enc->mb_per_pict*sizeof(struct mbinfo));
 
-	cur_picture.blocks =
-		(int16_t (*)[64])bufalloc(mb_per_pict * block_count * sizeof(int16_t [64]));
+	enc->cur_picture.blocks =
+		(int16_t (*)[64])bufalloc(enc->mb_per_pict * enc->block_count * sizeof(int16_t [64]));
   
   
 /* open statistics output file */
-	if(statname[0]=='-') statfile = stdout;
+	if(enc->statname[0]=='-') enc->statfile = stdout;
 	else 
-	if(!(statfile = fopen(statname,"w")))
+	if(!(enc->statfile = fopen(enc->statname,"w")))
 	{
-      sprintf(errortext,"Couldn't create statistics output file %s",statname);
-      error(errortext);
+      sprintf(enc->errortext,"Couldn't create statistics output file %s",enc->statname);
+      error(enc->errortext);
 	}
 
-	ratectl = malloc(processors * sizeof(ratectl_t*));
-	for(i = 0; i < processors; i++)
-		ratectl[i] = calloc(1, sizeof(ratectl_t));
+	enc->ratectl = calloc(enc->processors, sizeof(ratectl_t*));
+	for(i = 0; i < enc->processors; i++)
+		enc->ratectl[i] = calloc(1, sizeof(ratectl_t));
 	
 
 
@@ -340,8 +451,12 @@ static void init()
 void error(text)
 char *text;
 {
-  fprintf(stderr, "%s\n", text);
-  exit(1);
+	fprintf(stderr, "%s\n", text);
+	enc->error = 1;
+/* Only the encoding thread can unwind.  Engine threads just flag the error */
+/* and putseq stops after the current frame. */
+	if(pthread_equal(pthread_self(), enc->thread))
+		longjmp(enc->error_jump, 1);
 }
 
 #define STRINGLEN 254
@@ -414,29 +529,29 @@ static void readcmdline(int argc, char *argv[])
 	int isnum = 1;
 
 //printf("readcmdline 1\n");
-	frame0 =                   0;  /* number of first frame */
-	start_frame = end_frame = -1;
-	use_hires_quant = 0;
-	use_denoise_quant = 0;
-	quiet = 1;
-	bit_rate = 5000000;                       /* default bit_rate (bits/s) */
-	prog_seq = 0;                        /* progressive_sequence is faster */
-	mpeg1 = 0;                                   /* ISO/IEC 11172-2 stream */
-    fixed_mquant = 0;                             /* vary the quantization */
-	quant_floor = 0;
-	act_boost = 3.0;
-	N = 15;                                      /* N (# of frames in GOP) */
-	M = 1;  /* M (I/P frame distance) */
-	processors = calculate_smp();
-	frame_rate = -1;
-	chroma_format =            1;  /* chroma_format: 1=4:2:0, 2=4:2:2, 3=4:4:4   LibMPEG3 only does 1 */
-	mpeg_file = 0;
-	qt_file = 0;
-	do_stdin = 0;
-	do_buffers = 1;
-	seq_header_every_gop = 0;
+	enc->frame0 =                   0;  /* number of first frame */
+	enc->start_frame = enc->end_frame = -1;
+	enc->use_hires_quant = 0;
+	enc->use_denoise_quant = 0;
+	enc->quiet = 1;
+	enc->bit_rate = 5000000;                       /* default bit_rate (bits/s) */
+	enc->prog_seq = 0;                        /* progressive_sequence is faster */
+	enc->mpeg1 = 0;                                   /* ISO/IEC 11172-2 stream */
+    enc->fixed_mquant = 0;                             /* vary the quantization */
+	enc->quant_floor = 0;
+	enc->act_boost = 3.0;
+	enc->N = 15;                                      /* N (# of frames in GOP) */
+	enc->M = 1;  /* M (I/P frame distance) */
+	enc->processors = calculate_smp();
+	enc->frame_rate = -1;
+	enc->chroma_format =            1;  /* chroma_format: 1=4:2:0, 2=4:2:2, 3=4:4:4   LibMPEG3 only does 1 */
+	enc->mpeg_file = 0;
+	enc->qt_file = 0;
+	enc->do_stdin = 0;
+	enc->do_buffers = 1;
+	enc->seq_header_every_gop = 0;
 /* aspect_ratio_information 1=square pel, 2=4:3, 3=16:9, 4=2.11:1 */
-	aspectratio = 1;  
+	enc->aspectratio = 1;  
 
 
 
@@ -445,8 +560,8 @@ static void readcmdline(int argc, char *argv[])
 //printf("readcmdline 2\n");
 
 
-	tplorg[0] = 0;
-	out_path[0] = 0;
+	enc->tplorg[0] = 0;
+	enc->out_path[0] = 0;
 
 #define INTTOYES(x) ((x) ? "Yes" : "No")
 // This isn't used anymore as this is a library entry point.
@@ -476,14 +591,14 @@ static void readcmdline(int argc, char *argv[])
 "   15 frames between I frames   0 frames between P frames\n\n"
 "For the recommended encoding parameters see docs/index.html.\n",
 argv[0], 
-mpeg1 ? "MPEG-1" : "MPEG-2",
-(int)bit_rate,
-INTTOYES(use_denoise_quant),
-INTTOYES(use_hires_quant),
-M - 1,
-N,
-INTTOYES(prog_seq));
-    exit(1);
+enc->mpeg1 ? "MPEG-1" : "MPEG-2",
+(int)enc->bit_rate,
+INTTOYES(enc->use_denoise_quant),
+INTTOYES(enc->use_hires_quant),
+enc->M - 1,
+enc->N,
+INTTOYES(enc->prog_seq));
+    error("No arguments given.");
   }
 //printf("readcmdline 3\n");
 
@@ -500,7 +615,7 @@ INTTOYES(prog_seq));
 //printf("readcmdline %s\n", argv[i]);
 		if(!strcmp(argv[i], "-1"))
 		{
-			mpeg1 = 1;
+			enc->mpeg1 = 1;
 		}
 		else
 		if(!strcmp(argv[i], "-a"))
@@ -508,12 +623,11 @@ INTTOYES(prog_seq));
 			i++;
 			if(i < argc)
 			{
-				aspectratio = atoi(argv[i]);
+				enc->aspectratio = atoi(argv[i]);
 			}
 			else
 			{
-				fprintf(stderr, "-i needs an aspect ratio enumeration.\n");
-				exit(1);
+				error("-i needs an aspect ratio enumeration.");
 			}
 		}
 		else
@@ -522,18 +636,17 @@ INTTOYES(prog_seq));
 			i++;
 			if(i < argc)
 			{
-				bit_rate = atol(argv[i]);
+				enc->bit_rate = atol(argv[i]);
 			}
 			else
 			{
-				fprintf(stderr, "-b requires a bitrate\n");
-				exit(1);
+				error("-b requires a bitrate");
 			}
 		}
 		else
 		if(!strcmp(argv[i], "-d"))
 		{
-			use_denoise_quant = 1;
+			enc->use_denoise_quant = 1;
 		}
 		else
 		if(!strcmp(argv[i], "-f"))
@@ -541,18 +654,17 @@ INTTOYES(prog_seq));
 			i++;
 			if(i < argc)
 			{
-				frame_rate = atof(argv[i]);
+				enc->frame_rate = atof(argv[i]);
 			}
 			else
 			{
-				fprintf(stderr, "-f requires a frame rate\n");
-				exit(1);
+				error("-f requires a frame rate");
 			}
 		}
 		else
 		if(!strcmp(argv[i], "-h"))
 		{
-			use_hires_quant = 1;
+			enc->use_hires_quant = 1;
 		}
 		else
 		if(!strcmp(argv[i], "-m"))
@@ -560,12 +672,11 @@ INTTOYES(prog_seq));
 			i++;
 			if(i < argc)
 			{
-				M = atol(argv[i]) + 1;
+				enc->M = atol(argv[i]) + 1;
 			}
 			else
 			{
-				fprintf(stderr, "-m requires a frame count\n");
-				exit(1);
+				error("-m requires a frame count");
 			}
 		}
 		else
@@ -574,18 +685,17 @@ INTTOYES(prog_seq));
 			i++;
 			if(i < argc)
 			{
-				N = atol(argv[i]);
+				enc->N = atol(argv[i]);
 			}
 			else
 			{
-				fprintf(stderr, "-n requires a frame count\n");
-				exit(1);
+				error("-n requires a frame count");
 			}
 		}
 		else
 		if(!strcmp(argv[i], "-p"))
 		{
-			prog_seq = 1;
+			enc->prog_seq = 1;
 		}
 		else
 		if(!strcmp(argv[i], "-q"))
@@ -593,119 +703,115 @@ INTTOYES(prog_seq));
 			i++;
 			if(i < argc)
 			{
-				fixed_mquant = atol(argv[i]);
+				enc->fixed_mquant = atol(argv[i]);
 			}
 			else
 			{
-				fprintf(stderr, "-q requires a quantization value\n");
-				exit(1);
+				error("-q requires a quantization value");
 			}
 		}
 		else
 		if(!strcmp(argv[i], "-u"))
 		{
-			processors = 1;
+			enc->processors = 1;
 		}
 		else
 		if(!strcmp(argv[i], "-422"))
 		{
-			chroma_format = 2;
+			enc->chroma_format = 2;
 		}
 		else
 		if(!strcmp(argv[i], "-g"))
 		{
-			seq_header_every_gop = 1;
+			enc->seq_header_every_gop = 1;
 		}
 		else
 		if(!strcmp(argv[i], "-"))
 		{
-			do_stdin = 1;
+			enc->do_stdin = 1;
 		}
 		else
 /* Start or end frame if number */
 		if(isnum)
 		{
-			if(start_frame < 0)
-				start_frame = atol(argv[i]);
+			if(enc->start_frame < 0)
+				enc->start_frame = atol(argv[i]);
 			else
-			if(end_frame < 0)
-				end_frame = atol(argv[i]);
+			if(enc->end_frame < 0)
+				enc->end_frame = atol(argv[i]);
 		}
 		else
-		if(!strlen(tplorg) && !do_stdin && !do_buffers)
+		if(!strlen(enc->tplorg) && !enc->do_stdin && !enc->do_buffers)
 		{
 /* Input path */
-			strncpy(tplorg, argv[i], STRINGLEN);
+			strncpy(enc->tplorg, argv[i], STRINGLEN);
 		}
 		else
-		if(!strlen(out_path))
+		if(!strlen(enc->out_path))
 		{
 /* Output path */
-			strncpy(out_path, argv[i], STRINGLEN);
+			strncpy(enc->out_path, argv[i], STRINGLEN);
 		}
 	}
 //printf("readcmdline 4\n");
 
-	if(!strlen(out_path))
+	if(!strlen(enc->out_path))
 	{
 // Default output path
-		strncpy(out_path, tplorg, STRINGLEN);
-		for(i = strlen(out_path) - 1; i >= 0 && out_path[i] != '.'; i--)
+		strncpy(enc->out_path, enc->tplorg, STRINGLEN);
+		for(i = strlen(enc->out_path) - 1; i >= 0 && enc->out_path[i] != '.'; i--)
 			;
 
-		if(i < 0) i = strlen(out_path);
+		if(i < 0) i = strlen(enc->out_path);
 		
-		if(mpeg1)
-			sprintf(&out_path[i], ".m1v");
+		if(enc->mpeg1)
+			sprintf(&enc->out_path[i], ".m1v");
 		else
-			sprintf(&out_path[i], ".m2v");
+			sprintf(&enc->out_path[i], ".m2v");
 	}
 //printf("readcmdline 5\n");
 
 /* Get info from input file */
-	if(do_stdin)
+	if(enc->do_stdin)
 	{
-		inputtype = T_STDIN;
+		enc->inputtype = T_STDIN;
 	}
 	else
-	if(do_buffers)
+	if(enc->do_buffers)
 	{
-		inputtype = T_BUFFERS;
+		enc->inputtype = T_BUFFERS;
 	}
 	else
-	if(mpeg3_check_sig(tplorg))
+	if(mpeg3_check_sig(enc->tplorg))
 	{
 		int error_return;
-		mpeg_file = mpeg3_open(tplorg, &error_return);
-		inputtype = T_MPEG;
+		enc->mpeg_file = mpeg3_open(enc->tplorg, &error_return);
+		enc->inputtype = T_MPEG;
 	}
 	else
-	if(quicktime_check_sig(tplorg))
+	if(quicktime_check_sig(enc->tplorg))
 	{
-		qt_file = quicktime_open(tplorg, 1, 0);
-		inputtype = T_QUICKTIME;
+		enc->qt_file = quicktime_open(enc->tplorg, 1, 0);
+		enc->inputtype = T_QUICKTIME;
 	}
 //printf("readcmdline 6\n");
 
-	if(!qt_file && !mpeg_file && !do_stdin && !do_buffers)
+	if(!enc->qt_file && !enc->mpeg_file && !enc->do_stdin && !enc->do_buffers)
 	{
-		fprintf(stderr, "File format not recognized.\n");
-		exit(1);
+		error("File format not recognized.");
 	}
 
 //printf("readcmdline 7\n");
-	if(qt_file)
+	if(enc->qt_file)
 	{
-		if(!quicktime_video_tracks(qt_file))
+		if(!quicktime_video_tracks(enc->qt_file))
 		{
-			fprintf(stderr, "No video tracks in file.\n");
-			exit(1);
+			error("No video tracks in file.");
 		}
 
-		if(!quicktime_supported_video(qt_file, 0))
+		if(!quicktime_supported_video(enc->qt_file, 0))
 		{
-			fprintf(stderr, "Unsupported video codec.\n");
-			exit(1);
+			error("Unsupported video codec.");
 		}
 	}
 //printf("readcmdline 8\n");
@@ -715,167 +821,167 @@ INTTOYES(prog_seq));
  ************************************************************************/
 
 /* To eliminate the user hassle we replaced the parameter file with hard coded constants. */
-	strcpy(tplref,             "-");  /* name of intra quant matrix file	 ("-": default matrix) */
-	strcpy(iqname,             "-");  /* name of intra quant matrix file	 ("-": default matrix) */
-	strcpy(niqname,            "-");  /* name of non intra quant matrix file ("-": default matrix) */
-	strcpy(statname,           "/dev/null");  /* name of statistics file ("-": stdout ) */
+	strcpy(enc->tplref,             "-");  /* name of intra quant matrix file	 ("-": default matrix) */
+	strcpy(enc->iqname,             "-");  /* name of intra quant matrix file	 ("-": default matrix) */
+	strcpy(enc->niqname,            "-");  /* name of non intra quant matrix file ("-": default matrix) */
+	strcpy(enc->statname,           "/dev/null");  /* name of statistics file ("-": stdout ) */
 
-	if(qt_file)
+	if(enc->qt_file)
 	{
-		nframes =                  quicktime_video_length(qt_file, 0);  /* number of frames */
-		horizontal_size =          quicktime_video_width(qt_file, 0);
-		vertical_size =            quicktime_video_height(qt_file, 0);
+		enc->nframes =                  quicktime_video_length(enc->qt_file, 0);  /* number of frames */
+		enc->horizontal_size =          quicktime_video_width(enc->qt_file, 0);
+		enc->vertical_size =            quicktime_video_height(enc->qt_file, 0);
 	}
 	else
-	if(mpeg_file)
+	if(enc->mpeg_file)
 	{
-		nframes =                  0x7fffffff;  /* Use percentage instead */
-		horizontal_size =          mpeg3_video_width(mpeg_file, 0);
-		vertical_size =            mpeg3_video_height(mpeg_file, 0);
+		enc->nframes =                  0x7fffffff;  /* Use percentage instead */
+		enc->horizontal_size =          mpeg3_video_width(enc->mpeg_file, 0);
+		enc->vertical_size =            mpeg3_video_height(enc->mpeg_file, 0);
 	}
 	else
-	if(do_stdin)
+	if(enc->do_stdin)
 	{
 		unsigned char data[1024];
-		nframes =                  0x7fffffff;
+		enc->nframes =                  0x7fffffff;
 		
-		horizontal_size = vertical_size = 0;
-		if(fgets(data, 1024, stdin_fd))
-			horizontal_size = atol(data);
-		if(fgets(data, 1024, stdin_fd))
-			vertical_size = atol(data);
+		enc->horizontal_size = enc->vertical_size = 0;
+		if(fgets(data, 1024, enc->stdin_fd))
+			enc->horizontal_size = atol(data);
+		if(fgets(data, 1024, enc->stdin_fd))
+			enc->vertical_size = atol(data);
 	}
 	else
-	if(do_buffers)
+	if(enc->do_buffers)
 	{
-		nframes = 0x7fffffff;
+		enc->nframes = 0x7fffffff;
 	}
 	
 	
 	h = m = s = f =            0;  /* timecode of first frame */
-	fieldpic =                 0;  /* 0: progressive, 1: bottom first, 2: top first, 3 = progressive seq, field MC and DCT in picture */
-	low_delay =                0;  /* low_delay  */
-	constrparms =              0;  /* constrained_parameters_flag */
-	profile =                  4;  /* Profile ID: Simple = 5, Main = 4, SNR = 3, Spatial = 2, High = 1 */
-	level =                    4;  /* Level ID:   Low = 10, Main = 8, High 1440 = 6, High = 4		   */
-	video_format =             2;  /* video_format: 0=comp., 1=PAL, 2=NTSC, 3=SECAM, 4=MAC, 5=unspec. */
-	color_primaries =          5;  /* color_primaries */
-	dctsatlim		= mpeg1 ? 255 : 2047;
-	dctsatlim = 255;
-	transfer_characteristics = 5;  /* transfer_characteristics */
-	matrix_coefficients =      4;  /* matrix_coefficients (not used) */
-	display_horizontal_size =  horizontal_size;
-	display_vertical_size =    vertical_size;
-	cur_picture.dc_prec =      0;  /* intra_dc_precision (0: 8 bit, 1: 9 bit, 2: 10 bit, 3: 11 bit */
-	cur_picture.topfirst =     1;  /* top_field_first */
-
-	frame_pred_dct_tab[0] =    mpeg1 ? 1 : 0;  /* frame_pred_frame_dct (I P B) */
-	frame_pred_dct_tab[1] =    mpeg1 ? 1 : 0;  /* frame_pred_frame_dct (I P B) */
-	frame_pred_dct_tab[2] =    mpeg1 ? 1 : 0;  /* frame_pred_frame_dct (I P B) */
-
-	conceal_tab[0]  		 = 0;  /* concealment_motion_vectors (I P B) */
-	conceal_tab[1]  		 = 0;  /* concealment_motion_vectors (I P B) */
-	conceal_tab[2]  		 = 0;  /* concealment_motion_vectors (I P B) */
-	qscale_tab[0]   		 = mpeg1 ? 0 : 1;  /* q_scale_type  (I P B) */
-	qscale_tab[1]   		 = mpeg1 ? 0 : 1;  /* q_scale_type  (I P B) */
-	qscale_tab[2]   		 = mpeg1 ? 0 : 1;  /* q_scale_type  (I P B) */
-
-	intravlc_tab[0] 		 = 0;  /* intra_vlc_format (I P B)*/
-	intravlc_tab[1] 		 = 0;  /* intra_vlc_format (I P B)*/
-	intravlc_tab[2] 		 = 0;  /* intra_vlc_format (I P B)*/
-	altscan_tab[0]  		 = 0;  /* alternate_scan_hv (I P B) */
-	altscan_tab[1]  		 = 0;  /* alternate_scan_hv (I P B) */
-	altscan_tab[2]  		 = 0;  /* alternate_scan_hv (I P B) */
-	opt_dc_prec         = 0;  /* 8 bits */
-	opt_topfirst        = (fieldpic == 2);
-	opt_repeatfirst     = 0;
-	opt_prog_frame      = prog_seq;
-	cur_picture.repeatfirst =              0;  /* repeat_first_field */
-	cur_picture.prog_frame =               prog_seq;  /* progressive_frame */
+	enc->fieldpic =                 0;  /* 0: progressive, 1: bottom first, 2: top first, 3 = progressive seq, field MC and DCT in picture */
+	enc->low_delay =                0;  /* low_delay  */
+	enc->constrparms =              0;  /* constrained_parameters_flag */
+	enc->profile =                  4;  /* Profile ID: Simple = 5, Main = 4, SNR = 3, Spatial = 2, High = 1 */
+	enc->level =                    4;  /* Level ID:   Low = 10, Main = 8, High 1440 = 6, High = 4		   */
+	enc->video_format =             2;  /* video_format: 0=comp., 1=PAL, 2=NTSC, 3=SECAM, 4=MAC, 5=unspec. */
+	enc->color_primaries =          5;  /* color_primaries */
+	enc->dctsatlim		= enc->mpeg1 ? 255 : 2047;
+	enc->dctsatlim = 255;
+	enc->transfer_characteristics = 5;  /* transfer_characteristics */
+	enc->matrix_coefficients =      4;  /* matrix_coefficients (not used) */
+	enc->display_horizontal_size =  enc->horizontal_size;
+	enc->display_vertical_size =    enc->vertical_size;
+	enc->cur_picture.dc_prec =      0;  /* intra_dc_precision (0: 8 bit, 1: 9 bit, 2: 10 bit, 3: 11 bit */
+	enc->cur_picture.topfirst =     1;  /* top_field_first */
+
+	enc->frame_pred_dct_tab[0] =    enc->mpeg1 ? 1 : 0;  /* frame_pred_frame_dct (I P B) */
+	enc->frame_pred_dct_tab[1] =    enc->mpeg1 ? 1 : 0;  /* frame_pred_frame_dct (I P B) */
+	enc->frame_pred_dct_tab[2] =    enc->mpeg1 ? 1 : 0;  /* frame_pred_frame_dct (I P B) */
+
+	enc->conceal_tab[0]  		 = 0;  /* concealment_motion_vectors (I P B) */
+	enc->conceal_tab[1]  		 = 0;  /* concealment_motion_vectors (I P B) */
+	enc->conceal_tab[2]  		 = 0;  /* concealment_motion_vectors (I P B) */
+	enc->qscale_tab[0]   		 = enc->mpeg1 ? 0 : 1;  /* q_scale_type  (I P B) */
+	enc->qscale_tab[1]   		 = enc->mpeg1 ? 0 : 1;  /* q_scale_type  (I P B) */
+	enc->qscale_tab[2]   		 = enc->mpeg1 ? 0 : 1;  /* q_scale_type  (I P B) */
+
+	enc->intravlc_tab[0] 		 = 0;  /* intra_vlc_format (I P B)*/
+	enc->intravlc_tab[1] 		 = 0;  /* intra_vlc_format (I P B)*/
+	enc->intravlc_tab[2] 		 = 0;  /* intra_vlc_format (I P B)*/
+	enc->altscan_tab[0]  		 = 0;  /* alternate_scan_hv (I P B) */
+	enc->altscan_tab[1]  		 = 0;  /* alternate_scan_hv (I P B) */
+	enc->altscan_tab[2]  		 = 0;  /* alternate_scan_hv (I P B) */
+	enc->opt_dc_prec         = 0;  /* 8 bits */
+	enc->opt_topfirst        = (enc->fieldpic == 2);
+	enc->opt_repeatfirst     = 0;
+	enc->opt_prog_frame      = enc->prog_seq;
+	enc->cur_picture.repeatfirst =              0;  /* repeat_first_field */
+	enc->cur_picture.prog_frame =               enc->prog_seq;  /* progressive_frame */
 /* P:  forw_hor_f_code forw_vert_f_code search_width/height */
-    motion_data = (struct motion_data *)malloc(3 * sizeof(struct motion_data));
-	video_buffer_size =        46 * 1024 * 8;
+    enc->motion_data = (struct motion_data *)malloc(3 * sizeof(struct motion_data));
+	enc->video_buffer_size =        46 * 1024 * 8;
 
 /************************************************************************
  *                                END PARAMETER FILE
  ************************************************************************/
 //printf("readcmdline 10\n");
 
-	if(mpeg1)
+	if(enc->mpeg1)
 	{
-		opt_prog_frame = 1;
-		cur_picture.prog_frame = 1;
-		prog_seq = 1;
+		enc->opt_prog_frame = 1;
+		enc->cur_picture.prog_frame = 1;
+		enc->prog_seq = 1;
 	}
 
-	if(qt_file)
+	if(enc->qt_file)
 	{
-		input_frame_rate = quicktime_frame_rate(qt_file, 0);
+		enc->input_frame_rate = quicktime_frame_rate(enc->qt_file, 0);
 	}
 	else
-	if(mpeg_file)
+	if(enc->mpeg_file)
 	{
-		input_frame_rate = mpeg3_frame_rate(mpeg_file, 0);
+		enc->input_frame_rate = mpeg3_frame_rate(enc->mpeg_file, 0);
 	}
 	else
-	if(do_stdin)
+	if(enc->do_stdin)
 	{
 		char data[1024];
 		
-		input_frame_rate = 0;
-		if(fgets(data, 1024, stdin_fd))
-			input_frame_rate = atof(data);
+		enc->input_frame_rate = 0;
+		if(fgets(data, 1024, enc->stdin_fd))
+			enc->input_frame_rate = atof(data);
 	}
 	
 	
-	if(frame_rate < 0)
+	if(enc->frame_rate < 0)
 	{
-		frame_rate = input_frame_rate;
+		enc->frame_rate = enc->input_frame_rate;
 	}
 //printf("readcmdline 11\n");
 
 //processors = 1;
 //nframes = 16;
-	if(start_frame >= 0 && end_frame >= 0)
+	if(enc->start_frame >= 0 && enc->end_frame >= 0)
 	{
-		nframes = end_frame - start_frame;
-		frame0 = start_frame;
+		enc->nframes = enc->end_frame - enc->start_frame;
+		enc->frame0 = enc->start_frame;
 	}
 	else
-	if(start_frame >= 0)
+	if(enc->start_frame >= 0)
 	{
-		end_frame = nframes;
-		nframes -= start_frame;
-		frame0 = start_frame;
+		enc->end_frame = enc->nframes;
+		enc->nframes -= enc->start_frame;
+		enc->frame0 = enc->start_frame;
 	}
 	else
 	{
-		start_frame = 0;
-		end_frame = nframes;
+		enc->start_frame = 0;
+		enc->end_frame = enc->nframes;
 	}
 //printf("readcmdline 12\n");
 
 // Show status
-	if(verbose)
+	if(enc->verbose)
 	{
-		printf("Encoding: %s frames %d\n", out_path, nframes);
+		printf("Encoding: %s frames %d\n", enc->out_path, enc->nframes);
 
-    	if(fixed_mquant == 0) 
-    		printf("   bitrate %.0f\n", bit_rate);
+    	if(enc->fixed_mquant == 0) 
+    		printf("   bitrate %.0f\n", enc->bit_rate);
     	else
-    		printf("   quantization %d\n", fixed_mquant);
-    	printf("   %d frames between I frames   %d frames between P frames\n", N, M - 1);
-    	printf("   %s\n", (prog_seq ? "progressive" : "interlaced"));
-		printf("   %s\n", (mpeg1 ? "MPEG-1" : "MPEG-2"));
-		printf("   %s\n", (chroma_format == 1) ? "YUV-420" : "YUV-422");
-		printf("   %d processors\n", processors);
-		printf("   %.02f frames per second\n", frame_rate);
-		printf("   Denoise %s\n", INTTOYES(use_denoise_quant));
-		printf("   Aspect ratio index %d\n", aspectratio);
-		printf("   Hires quantization %s\n", INTTOYES(use_hires_quant));
-
-
-		if(mpeg_file)
+    		printf("   quantization %d\n", enc->fixed_mquant);
+    	printf("   %d frames between I frames   %d frames between P frames\n", enc->N, enc->M - 1);
+    	printf("   %s\n", (enc->prog_seq ? "progressive" : "interlaced"));
+		printf("   %s\n", (enc->mpeg1 ? "MPEG-1" : "MPEG-2"));
+		printf("   %s\n", (enc->chroma_format == 1) ? "YUV-420" : "YUV-422");
+		printf("   %d processors\n", enc->processors);
+		printf("   %.02f frames per second\n", enc->frame_rate);
+		printf("   Denoise %s\n", INTTOYES(enc->use_denoise_quant));
+		printf("   Aspect ratio index %d\n", enc->aspectratio);
+		printf("   Hires quantization %s\n", INTTOYES(enc->use_hires_quant));
+
+
+		if(enc->mpeg_file)
 		{
 			fprintf(stderr, "(MPEG to MPEG transcoding for official use only.)\n");
 		}
@@ -885,97 +991,97 @@ INTTOYES(prog_seq));
 
 	{ 
 		int radius_x = ((param_searchrad + 4) / 8) * 8;
-		int radius_y = ((param_searchrad * vertical_size / horizontal_size + 4) / 8) * 8;
+		int radius_y = ((param_searchrad * enc->vertical_size / enc->horizontal_size + 4) / 8) * 8;
 		int c;
 	
 		/* TODO: These f-codes should really be adjusted for each
 		   picture type... */
 		c=5;
-		if( radius_x*M < 64) c = 4;
-		if( radius_x*M < 32) c = 3;
-		if( radius_x*M < 16) c = 2;
-		if( radius_x*M < 8) c = 1;
+		if( radius_x*enc->M < 64) c = 4;
+		if( radius_x*enc->M < 32) c = 3;
+		if( radius_x*enc->M < 16) c = 2;
+		if( radius_x*enc->M < 8) c = 1;
 
-		if (!motion_data)
+		if (!enc->motion_data)
 			error("malloc failed\n");
 
-		for (i=0; i<M; i++)
+		for (i=0; i<enc->M; i++)
 		{
 			if(i==0)
 			{
-				motion_data[i].forw_hor_f_code  = c;
-				motion_data[i].forw_vert_f_code = c;
-				motion_data[i].sxf = MAX(1,radius_x*M);
-				motion_data[i].syf = MAX(1,radius_y*M);
+				enc->motion_data[i].forw_hor_f_code  = c;
+				enc->motion_data[i].forw_vert_f_code = c;
+				enc->motion_data[i].sxf = MAX(1,radius_x*enc->M);
+				enc->motion_data[i].syf = MAX(1,radius_y*enc->M);
 			}
 			else
 			{
-				motion_data[i].forw_hor_f_code  = c;
-				motion_data[i].forw_vert_f_code = c;
-				motion_data[i].sxf = MAX(1,radius_x*i);
-				motion_data[i].syf = MAX(1,radius_y*i);
-				motion_data[i].back_hor_f_code  = c;
-				motion_data[i].back_vert_f_code = c;
-				motion_data[i].sxb = MAX(1,radius_x*(M-i));
-				motion_data[i].syb = MAX(1,radius_y*(M-i));
+				enc->motion_data[i].forw_hor_f_code  = c;
+				enc->motion_data[i].forw_vert_f_code = c;
+				enc->motion_data[i].sxf = MAX(1,radius_x*i);
+				enc->motion_data[i].syf = MAX(1,radius_y*i);
+				enc->motion_data[i].back_hor_f_code  = c;
+				enc->motion_data[i].back_vert_f_code = c;
+				enc->motion_data[i].sxb = MAX(1,radius_x*(enc->M-i));
+				enc->motion_data[i].syb = MAX(1,radius_y*(enc->M-i));
 			}
 		}
 		
 	}
 
 //    vbv_buffer_size = floor(((double)bit_rate * 0.20343) / 16384.0);
-    if(mpeg1)
-		vbv_buffer_size = 20 * 16384;
+    if(enc->mpeg1)
+		enc->vbv_buffer_size = 20 * 16384;
 	else
-		vbv_buffer_size = 112 * 16384;
+		enc->vbv_buffer_size = 112 * 16384;
 
-	fast_mc_frac    = 10;
-	mc_44_red		= 2;
-	mc_22_red		= 3;
+	enc->fast_mc_frac    = 10;
+	enc->mc_44_red		= 2;
+	enc->mc_22_red		= 3;
 
-    if(vbv_buffer_size > vbvlim[(level - 4) >> 1])
-        vbv_buffer_size = vbvlim[(level - 4) >> 1];
+    if(enc->vbv_buffer_size > vbvlim[(enc->level - 4) >> 1])
+        enc->vbv_buffer_size = vbvlim[(enc->level - 4) >> 1];
 
 /* Set up frame buffers */
-	frame_buffer = malloc(horizontal_size * vertical_size * 3 + 4);
-	row_pointers = malloc(sizeof(unsigned char*) * vertical_size);
-	for(i = 0; i < vertical_size; i++) row_pointers[i] = &frame_buffer[horizontal_size * 3 * i];
+	enc->frame_buffer = malloc(enc->horizontal_size * enc->vertical_size * 3 + 4);
+	enc->row_pointers = malloc(sizeof(unsigned char*) * enc->vertical_size);
+	for(i = 0; i < enc->vertical_size; i++) enc->row_pointers[i] = &enc->frame_buffer[enc->horizontal_size * 3 * i];
 
 // Get frame rate code from input frame rate
 	for(i = 0; i < total_frame_rates; i++)
 	{
-		if(fabs(frame_rate - ratetab[i]) < 0.001) frame_rate_code = i + 1;
+		if(fabs(enc->frame_rate - ratetab[i]) < 0.001) enc->frame_rate_code = i + 1;
 	}
 
 /* make flags boolean (x!=0 -> x=1) */
-  mpeg1 = !!mpeg1;
-  fieldpic = !!fieldpic;
-  low_delay = !!low_delay;
-  constrparms = !!constrparms;
-  prog_seq = !!prog_seq;
-  cur_picture.topfirst = !!cur_picture.topfirst;
+  enc->mpeg1 = !!enc->mpeg1;
+  enc->fieldpic = !!enc->fieldpic;
+  enc->low_delay = !!enc->low_delay;
+  enc->constrparms = !!enc->constrparms;
+  enc->prog_seq = !!enc->prog_seq;
+  enc->cur_picture.topfirst = !!enc->cur_picture.topfirst;
 
   for (i = 0; i < 3; i++)
   {
-    frame_pred_dct_tab[i] = !!frame_pred_dct_tab[i];
-    conceal_tab[i] = !!conceal_tab[i];
-    qscale_tab[i] = !!qscale_tab[i];
-    intravlc_tab[i] = !!intravlc_tab[i];
-    altscan_tab[i] = !!altscan_tab[i];
+    enc->frame_pred_dct_tab[i] = !!enc->frame_pred_dct_tab[i];
+    enc->conceal_tab[i] = !!enc->conceal_tab[i];
+    enc->qscale_tab[i] = !!enc->qscale_tab[i];
+    enc->intravlc_tab[i] = !!enc->intravlc_tab[i];
+    enc->altscan_tab[i] = !!enc->altscan_tab[i];
   }
-  cur_picture.repeatfirst = !!cur_picture.repeatfirst;
-  cur_picture.prog_frame = !!cur_picture.prog_frame;
+  enc->cur_picture.repeatfirst = !!enc->cur_picture.repeatfirst;
+  enc->cur_picture.prog_frame = !!enc->cur_picture.prog_frame;
 
   /* make sure MPEG specific parameters are valid */
   range_checks();
 
   /* timecode -> frame number */
-  tc0 = h;
-  tc0 = 60*tc0 + m;
-  tc0 = 60*tc0 + s;
-  tc0 = (int)(frame_rate+0.5)*tc0 + f;
+  enc->tc0 = h;
+  enc->tc0 = 60*enc->tc0 + m;
+  enc->tc0 = 60*enc->tc0 + s;
+  enc->tc0 = (int)(enc->frame_rate+0.5)*enc->tc0 + f;
 
-  qt_output = 0;
+  enc->qt_output = 0;
 
 
 
@@ -986,141 +1092,141 @@ INTTOYES(prog_seq));
 
 
 
-  if (!mpeg1)
+  if (!enc->mpeg1)
   {
     profile_and_level_checks();
   }
   else
   {
     /* MPEG-1 */
-    if (constrparms)
+    if (enc->constrparms)
     {
-      if (horizontal_size>768
-          || vertical_size>576
-          || ((horizontal_size+15)/16)*((vertical_size+15) / 16) > 396
-          || ((horizontal_size+15)/16)*((vertical_size+15) / 16)*frame_rate>396*25.0
-          || frame_rate>30.0)
+      if (enc->horizontal_size>768
+          || enc->vertical_size>576
+          || ((enc->horizontal_size+15)/16)*((enc->vertical_size+15) / 16) > 396
+          || ((enc->horizontal_size+15)/16)*((enc->vertical_size+15) / 16)*enc->frame_rate>396*25.0
+          || enc->frame_rate>30.0)
       {
-        if (!quiet)
+        if (!enc->quiet)
           fprintf(stderr,"*** Warning: setting constrained_parameters_flag = 0\n");
-        constrparms = 0;
+        enc->constrparms = 0;
       }
     }
   }
 
   /* relational checks */
 
-  if (mpeg1)
+  if (enc->mpeg1)
   {
-    if (!prog_seq)
+    if (!enc->prog_seq)
     {
-      prog_seq = 1;
+      enc->prog_seq = 1;
     }
 
-    if (chroma_format!=CHROMA420)
+    if (enc->chroma_format!=CHROMA420)
     {
-      chroma_format = CHROMA420;
+      enc->chroma_format = CHROMA420;
     }
 
-    if (cur_picture.dc_prec!=0)
+    if (enc->cur_picture.dc_prec!=0)
     {
-      cur_picture.dc_prec = 0;
+      enc->cur_picture.dc_prec = 0;
     }
 
     for (i=0; i<3; i++)
-      if (qscale_tab[i])
+      if (enc->qscale_tab[i])
       {
-        qscale_tab[i] = 0;
+        enc->qscale_tab[i] = 0;
       }
 
     for (i=0; i<3; i++)
-      if (intravlc_tab[i])
+      if (enc->intravlc_tab[i])
       {
-        intravlc_tab[i] = 0;
+        enc->intravlc_tab[i] = 0;
       }
 
     for (i=0; i<3; i++)
-      if (altscan_tab[i])
+      if (enc->altscan_tab[i])
       {
-        altscan_tab[i] = 0;
+        enc->altscan_tab[i] = 0;
       }
   }
 
-  if (!mpeg1 && constrparms)
+  if (!enc->mpeg1 && enc->constrparms)
   {
-    constrparms = 0;
+    enc->constrparms = 0;
   }
 
-  if (prog_seq && !cur_picture.prog_frame)
+  if (enc->prog_seq && !enc->cur_picture.prog_frame)
   {
-    cur_picture.prog_frame = 1;
+    enc->cur_picture.prog_frame = 1;
   }
 
-  if (cur_picture.prog_frame && fieldpic)
+  if (enc->cur_picture.prog_frame && enc->fieldpic)
   {
-    fieldpic = 0;
+    enc->fieldpic = 0;
   }
 
-  if (!cur_picture.prog_frame && cur_picture.repeatfirst)
+  if (!enc->cur_picture.prog_frame && enc->cur_picture.repeatfirst)
   {
-    cur_picture.repeatfirst = 0;
+    enc->cur_picture.repeatfirst = 0;
   }
 
-  if (cur_picture.prog_frame)
+  if (enc->cur_picture.prog_frame)
   {
     for (i=0; i<3; i++)
-      if (!frame_pred_dct_tab[i])
+      if (!enc->frame_pred_dct_tab[i])
       {
-        frame_pred_dct_tab[i] = 1;
+        enc->frame_pred_dct_tab[i] = 1;
       }
   }
 
-  if (prog_seq && !cur_picture.repeatfirst && cur_picture.topfirst)
+  if (enc->prog_seq && !enc->cur_picture.repeatfirst && enc->cur_picture.topfirst)
   {
-     if (!quiet)
+     if (!enc->quiet)
        fprintf(stderr,"Warning: setting top_field_first = 0\n");
-    cur_picture.topfirst = 0;
+    enc->cur_picture.topfirst = 0;
   }
 
   /* search windows */
-  for (i=0; i<M; i++)
+  for (i=0; i<enc->M; i++)
   {
-    if (motion_data[i].sxf > (4<<motion_data[i].forw_hor_f_code)-1)
+    if (enc->motion_data[i].sxf > (4<<enc->motion_data[i].forw_hor_f_code)-1)
     {
-      if (!quiet)
+      if (!enc->quiet)
         fprintf(stderr,
           "Warning: reducing forward horizontal search width to %d\n",
-          (4<<motion_data[i].forw_hor_f_code)-1);
-      motion_data[i].sxf = (4<<motion_data[i].forw_hor_f_code)-1;
+          (4<<enc->motion_data[i].forw_hor_f_code)-1);
+      enc->motion_data[i].sxf = (4<<enc->motion_data[i].forw_hor_f_code)-1;
     }
 
-    if (motion_data[i].syf > (4<<motion_data[i].forw_vert_f_code)-1)
+    if (enc->motion_data[i].syf > (4<<enc->motion_data[i].forw_vert_f_code)-1)
     {
-      if (!quiet)
+      if (!enc->quiet)
         fprintf(stderr,
           "Warning: reducing forward vertical search width to %d\n",
-          (4<<motion_data[i].forw_vert_f_code)-1);
-      motion_data[i].syf = (4<<motion_data[i].forw_vert_f_code)-1;
+          (4<<enc->motion_data[i].forw_vert_f_code)-1);
+      enc->motion_data[i].syf = (4<<enc->motion_data[i].forw_vert_f_code)-1;
     }
 
     if (i!=0)
     {
-      if (motion_data[i].sxb > (4<<motion_data[i].back_hor_f_code)-1)
+      if (enc->motion_data[i].sxb > (4<<enc->motion_data[i].back_hor_f_code)-1)
       {
-        if (!quiet)
+        if (!enc->quiet)
           fprintf(stderr,
             "Warning: reducing backward horizontal search width to %d\n",
-            (4<<motion_data[i].back_hor_f_code)-1);
-        motion_data[i].sxb = (4<<motion_data[i].back_hor_f_code)-1;
+            (4<<enc->motion_data[i].back_hor_f_code)-1);
+        enc->motion_data[i].sxb = (4<<enc->motion_data[i].back_hor_f_code)-1;
       }
 
-      if (motion_data[i].syb > (4<<motion_data[i].back_vert_f_code)-1)
+      if (enc->motion_data[i].syb > (4<<enc->motion_data[i].back_vert_f_code)-1)
       {
-        if (!quiet)
+        if (!enc->quiet)
           fprintf(stderr,
             "Warning: reducing backward vertical search width to %d\n",
-            (4<<motion_data[i].back_vert_f_code)-1);
-        motion_data[i].syb = (4<<motion_data[i].back_vert_f_code)-1;
+            (4<<enc->motion_data[i].back_vert_f_code)-1);
+        enc->motion_data[i].syb = (4<<enc->motion_data[i].back_vert_f_code)-1;
       }
     }
   }
@@ -1140,7 +1246,7 @@ static int quant_hfnoise_filt(int orgquant, int qmat_pos )
 	int y = qmat_pos / 8;
 	int qboost = 1024;
 
-	if(!use_denoise_quant)
+	if(!enc->use_denoise_quant)
 	{
 		return orgquant;
 	}
@@ -1157,75 +1263,75 @@ static int quant_hfnoise_filt(int orgquant, int qmat_pos )
 static void readquantmat()
 {
   int i,v,q;
-	load_iquant = 0;
-	load_niquant = 0;
+	enc->load_iquant = 0;
+	enc->load_niquant = 0;
 
-  if (iqname[0]=='-')
+  if (enc->iqname[0]=='-')
   {
-  	if(use_hires_quant)
+  	if(enc->use_hires_quant)
 	{
-		load_iquant |= 1;
+		enc->load_iquant |= 1;
 		for (i=0; i<64; i++)
 		{
-			intra_q[i] = hires_intra_quantizer_matrix_hv[i];
+			enc->intra_q[i] = hires_intra_quantizer_matrix_hv[i];
 		}	
 	}
 	else
 	{
-		load_iquant = use_denoise_quant;
+		enc->load_iquant = enc->use_denoise_quant;
 		for (i=0; i<64; i++)
 		{
 			v = quant_hfnoise_filt(default_intra_quantizer_matrix_hv[i], i);
 			if (v<1 || v>255)
 				error("value in intra quant matrix invalid (after noise filt adjust)");
-			intra_q[i] = v;
+			enc->intra_q[i] = v;
 		} 
 	}
   }
 
 /* TODO: Inv Quant matrix initialisation should check if the fraction fits in 16 bits! */
-  if (niqname[0]=='-')
+  if (enc->niqname[0]=='-')
   {
-		if(use_hires_quant)
+		if(enc->use_hires_quant)
 		{
 			for (i=0; i<64; i++)
 			{
-				inter_q[i] = hires_nonintra_quantizer_matrix_hv[i];
+				enc->inter_q[i] = hires_nonintra_quantizer_matrix_hv[i];
 			}	
 		}
 		else
 		{
 /* default non-intra matrix is all 16's. For *our* default we use something
    more suitable for domestic analog sources... which is non-standard...*/
-			load_niquant |= 1;
+			enc->load_niquant |= 1;
 			for (i=0; i<64; i++)
 			{
 				v = quant_hfnoise_filt(default_nonintra_quantizer_matrix_hv[i],i);
 				if (v<1 || v>255)
 					error("value in non-intra quant matrix invalid (after noise filt adjust)");
-				inter_q[i] = v;
+				enc->inter_q[i] = v;
 			}
 		}
   }
 
 	for (i=0; i<64; i++)
 	{
-		i_intra_q[i] = (int)(((double)IQUANT_SCALE) / ((double)intra_q[i]));
-		i_inter_q[i] = (int)(((double)IQUANT_SCALE) / ((double)inter_q[i]));
+		enc->i_intra_q[i] = (int)(((double)IQUANT_SCALE) / ((double)enc->intra_q[i]));
+		enc->i_inter_q[i] = (int)(((double)IQUANT_SCALE) / ((double)enc->inter_q[i]));
 	}
 	
 	for( q = 1; q <= 112; ++q )
 	{
 		for (i=0; i<64; i++)
 		{
-			intra_q_tbl[q][i] = intra_q[i] * q;
-			inter_q_tbl[q][i] = inter_q[i] * q;
-			intra_q_tblf[q][i] = (float)intra_q_tbl[q][i];
-			inter_q_tblf[q][i] = (float)inter_q_tbl[q][i];
-			i_intra_q_tblf[q][i] = 1.0f/ ( intra_q_tblf[q][i] * 0.98);
-			i_intra_q_tbl[q][i] = (IQUANT_SCALE/intra_q_tbl[q][i]);
-			i_inter_q_tblf[q][i] =  1.0f/ (inter_q_tblf[q][i] * 0.98);
-			i_inter_q_tbl[q][i] = (IQUANT_SCALE/inter_q_tbl[q][i] );
+			enc->intra_q_tbl[q][i] = enc->intra_q[i] * q;
+			enc->inter_q_tbl[q][i] = enc->inter_q[i] * q;
+			enc->intra_q_tblf[q][i] = (float)enc->intra_q_tbl[q][i];
+			enc->inter_q_tblf[q][i] = (float)enc->inter_q_tbl[q][i];
+			enc->i_intra_q_tblf[q][i] = 1.0f/ ( enc->intra_q_tblf[q][i] * 0.98);
+			enc->i_intra_q_tbl[q][i] = (IQUANT_SCALE/enc->intra_q_tbl[q][i]);
+			enc->i_inter_q_tblf[q][i] =  1.0f/ (enc->inter_q_tblf[q][i] * 0.98);
+			enc->i_inter_q_tbl[q][i] = (IQUANT_SCALE/enc->inter_q_tbl[q][i] );
 		}
 	}
 }
@@ -0,0 +1,203 @@
+/* mpeg2enctest.c, runs several encoders in one process                     */
+
+/* Encodes two streams at once in separate threads and compares them with
+ * the same streams encoded one at a time.  Any state shared between the
+ * encoders shows up as a difference.  Also checks that a bad command line
+ * returns an error instead of exiting the process.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct mpeg2enc_s mpeg2enc_t;
+mpeg2enc_t* mpeg2enc_new();
+void mpeg2enc_delete(mpeg2enc_t *encoder);
+void mpeg2enc_init_buffers(mpeg2enc_t *encoder);
+int mpeg2enc(mpeg2enc_t *encoder, int argc, char *argv[]);
+void mpeg2enc_set_w(mpeg2enc_t *encoder, int width);
+void mpeg2enc_set_h(mpeg2enc_t *encoder, int height);
+void mpeg2enc_set_rate(mpeg2enc_t *encoder, double rate);
+int mpeg2enc_set_input_buffers(mpeg2enc_t *encoder, 
+	int eof, 
+	char *y, 
+	char *u, 
+	char *v);
+
+#define TOTAL_FRAMES 12
+#define TOTAL_STREAMS 2
+
+typedef struct
+{
+	int w;
+	int h;
+	int seed;
+	char path[256];
+	int result;
+} stream_t;
+
+/* Feeds frames to the encoder from the writer side, like FileMPEG does. */
+typedef struct
+{
+	mpeg2enc_t *encoder;
+	stream_t *stream;
+} writer_t;
+
+static void *write_frames(void *ptr)
+{
+	writer_t *writer = ptr;
+	stream_t *stream = writer->stream;
+	int w = stream->w;
+	int h = stream->h;
+	char *y = malloc(w * h);
+	char *u = malloc(w * h / 4);
+	char *v = malloc(w * h / 4);
+	int i, j, k;
+
+	for(i = 0; i < TOTAL_FRAMES; i++)
+	{
+		for(j = 0; j < h; j++)
+		{
+			for(k = 0; k < w; k++)
+			{
+				y[j * w + k] = (k * stream->seed + j + i * 4) & 0xff;
+			}
+		}
+
+		for(j = 0; j < w * h / 4; j++)
+		{
+			u[j] = (j / w + i + stream->seed) & 0xff;
+			v[j] = (j % w - i * 2) & 0xff;
+		}
+
+		if(mpeg2enc_set_input_buffers(writer->encoder, 0, y, u, v)) break;
+	}
+
+	mpeg2enc_set_input_buffers(writer->encoder, 1, 0, 0, 0);
+	free(y);
+	free(u);
+	free(v);
+	return 0;
+}
+
+static void *encode_stream(void *ptr)
+{
+	stream_t *stream = ptr;
+	mpeg2enc_t *encoder = mpeg2enc_new();
+	writer_t writer;
+	pthread_t tid;
+	char *argv[] = { "mpeg2enc", "-u", "-p", "-b", "2000000", "-n", "6", stream->path };
+
+	mpeg2enc_init_buffers(encoder);
+	mpeg2enc_set_w(encoder, stream->w);
+	mpeg2enc_set_h(encoder, stream->h);
+	mpeg2enc_set_rate(encoder, 25);
+
+	writer.encoder = encoder;
+	writer.stream = stream;
+	pthread_create(&tid, 0, write_frames, &writer);
+	stream->result = mpeg2enc(encoder, sizeof(argv) / sizeof(char*), argv);
+	pthread_join(tid, 0);
+	mpeg2enc_delete(encoder);
+	return 0;
+}
+
+static char* read_file(char *path, long *size)
+{
+	FILE *file = fopen(path, "rb");
+	char *data;
+
+	*size = 0;
+	if(!file) return 0;
+	fseek(file, 0, SEEK_END);
+	*size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	data = malloc(*size + 1);
+	if(fread(data, 1, *size, file) != *size) *size = 0;
+	fclose(file);
+	return data;
+}
+
+static int compare_files(char *path1, char *path2)
+{
+	long size1, size2;
+	char *data1 = read_file(path1, &size1);
+	char *data2 = read_file(path2, &size2);
+	int result = !data1 ||
+		!data2 ||
+		!size1 ||
+		size1 != size2 ||
+		memcmp(data1, data2, size1);
+
+	free(data1);
+	free(data2);
+	return result;
+}
+
+int main(int argc, char *argv[])
+{
+	stream_t serial[TOTAL_STREAMS];
+	stream_t parallel[TOTAL_STREAMS];
+	pthread_t tid[TOTAL_STREAMS];
+	char *tmp = getenv("TMPDIR");
+	int i;
+	int result = 0;
+
+	if(!tmp) tmp = "/tmp";
+
+	for(i = 0; i < TOTAL_STREAMS; i++)
+	{
+		serial[i].w = i ? 176 : 320;
+		serial[i].h = i ? 144 : 240;
+		serial[i].seed = i + 1;
+		parallel[i] = serial[i];
+		sprintf(serial[i].path, "%s/mpeg2enctest_%d_serial.m2v", tmp, i);
+		sprintf(parallel[i].path, "%s/mpeg2enctest_%d_parallel.m2v", tmp, i);
+	}
+
+	for(i = 0; i < TOTAL_STREAMS; i++)
+		encode_stream(&serial[i]);
+
+	for(i = 0; i < TOTAL_STREAMS; i++)
+		pthread_create(&tid[i], 0, encode_stream, &parallel[i]);
+	for(i = 0; i < TOTAL_STREAMS; i++)
+		pthread_join(tid[i], 0);
+
+	for(i = 0; i < TOTAL_STREAMS; i++)
+	{
+		if(serial[i].result || parallel[i].result)
+		{
+			fprintf(stderr, "stream %d: encoder failed\n", i);
+			result = 1;
+		}
+		else
+		if(compare_files(serial[i].path, parallel[i].path))
+		{
+			fprintf(stderr, "stream %d: concurrent encoding differs\n", i);
+			result = 1;
+		}
+		remove(serial[i].path);
+		remove(parallel[i].path);
+	}
+
+/* A bad command line must not take the process down */
+	{
+		mpeg2enc_t *encoder = mpeg2enc_new();
+		char *bad_argv[] = { "mpeg2enc", "-b" };
+		mpeg2enc_init_buffers(encoder);
+		if(!mpeg2enc(encoder, 2, bad_argv))
+		{
+			fprintf(stderr, "bad command line was accepted\n");
+			result = 1;
+		}
+		if(!mpeg2enc_set_input_buffers(encoder, 1, 0, 0, 0))
+		{
+			fprintf(stderr, "failed encoder accepted a frame\n");
+			result = 1;
+		}
+		mpeg2enc_delete(encoder);
+	}
+
+	return result;
+}
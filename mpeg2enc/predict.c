@@ -50,6 +50,40 @@ static void pred_comp (
 	pict_data_s *picture,
 	uint8_t *src, uint8_t *dst,
 	int lx, int w, int h, int x, int y, int dx, int dy, int addflag);
+#ifdef __SSE2__
+static void pred_comp_sse2(
+	pict_data_s *picture,
+	uint8_t *src, uint8_t *dst,
+	int lx, int w, int h, int x, int y, int dx, int dy, int addflag);
+#endif
+#ifdef __SSE2__
+static void pred_comp_sse2(
+	pict_data_s *picture,
+	uint8_t *src,
+	uint8_t *dst,
+	int lx,
+	int w, int h,
+	int x, int y,
+	int dx, int dy,
+	int addflag)
+{
+	int xint, xh, yint, yh;
+	uint8_t *s, *d;
+	
+	/* half pel scaling */
+	xint = dx>>1; /* integer part */
+	xh = dx & 1;  /* half pel flag */
+	yint = dy>>1;
+	yh = dy & 1;
+
+	/* origins */
+	s = src + lx*(y+yint) + (x+xint); /* motion vector */
+	d = dst + lx*y + x;
+
+	predcomp_sse2(s, d, lx, w, h, xh, yh, addflag);
+}
+#endif
+
 #ifdef X86_CPU
 static void pred_comp_mmxe(
 	pict_data_s *picture,
@@ -90,12 +124,12 @@ void init_predict_hv()
 #ifdef X86_CPU
 	else if(cpucap & ACCEL_X86_MMXEXT ) /* AMD MMX or SSE... */
 	{
-		if(verbose) fprintf( stderr, "SETTING EXTENDED MMX for PREDICTION!\n");
+		if(enc->verbose) fprintf( stderr, "SETTING EXTENDED MMX for PREDICTION!\n");
 		ppred_comp = pred_comp_mmxe;
 	}
     else if(cpucap & ACCEL_X86_MMX ) /* Original MMX... */
 	{
-		if(verbose) fprintf( stderr, "SETTING MMX for PREDICTION!\n");
+		if(enc->verbose) fprintf( stderr, "SETTING MMX for PREDICTION!\n");
 		ppred_comp = pred_comp_mmx;
 	}
 #endif
@@ -103,6 +137,14 @@ void init_predict_hv()
 	{
 		ppred_comp = pred_comp;
 	}
+
+#ifdef __SSE2__
+	if(cpucap & ACCEL_X86_SSE2)
+	{
+		if(enc->verbose) fprintf( stderr, "SETTING SSE2 for PREDICTION!\n");
+		ppred_comp = pred_comp_sse2;
+	}
+#endif
 }
 
 /* form prediction for a complete picture (frontend for predict_mb)
@@ -122,16 +164,30 @@ void predict(pict_data_s *picture,
 			 uint8_t *refb[],
 			 uint8_t *cur[3],
 			 int secondfield)
+{
+	predict_rows(picture, reff, refb, cur, secondfield, 0, enc->height2);
+}
+
+/* Same as predict for the macroblock rows from start_row to end_row.
+ * Used by the transform engines to predict their own rows in parallel.
+ */
+void predict_rows(pict_data_s *picture, 
+			 uint8_t *reff[],
+			 uint8_t *refb[],
+			 uint8_t *cur[3],
+			 int secondfield,
+			 int start_row,
+			 int end_row)
 {
 	int i, j, k;
 	mbinfo_s *mbi = picture->mbinfo;
-	k = 0;
+	k = (start_row / 16) * (enc->width / 16);
 
-	/* loop through all macroblocks of the picture */
-	for (j=0; j<height2; j+=16)
-		for (i=0; i<width; i+=16)
+	/* loop through all macroblocks of the rows */
+	for (j=start_row; j<end_row; j+=16)
+		for (i=0; i<enc->width; i+=16)
 		{
-			predict_mb(picture,reff,refb,cur,width,i,j,
+			predict_mb(picture,reff,refb,cur,enc->width,i,j,
 					   &mbi[k], secondfield );
 			k++;
 		}
@@ -405,12 +461,12 @@ static void pred (
 		if (cc==1)
 		{
 			/* scale for color components */
-			if (chroma_format==CHROMA420)
+			if (enc->chroma_format==CHROMA420)
 			{
 				/* vertical */
 				h >>= 1; y >>= 1; dy /= 2;
 			}
-			if (chroma_format!=CHROMA444)
+			if (enc->chroma_format!=CHROMA444)
 			{
 				/* horizontal */
 				w >>= 1; x >>= 1; dx /= 2;
@@ -674,44 +730,44 @@ static void clearblock(
   int i, j, w, h;
   uint8_t *p;
 
-  p = cur[0] + ((picture->pict_struct==BOTTOM_FIELD) ? width : 0) + i0 + width2*j0;
+  p = cur[0] + ((picture->pict_struct==BOTTOM_FIELD) ? enc->width : 0) + i0 + enc->width2*j0;
 
   for (j=0; j<16; j++)
   {
     for (i=0; i<16; i++)
       p[i] = 128;
-    p+= width2;
+    p+= enc->width2;
   }
 
   w = h = 16;
 
-  if (chroma_format!=CHROMA444)
+  if (enc->chroma_format!=CHROMA444)
   {
     i0>>=1; w>>=1;
   }
 
-  if (chroma_format==CHROMA420)
+  if (enc->chroma_format==CHROMA420)
   {
     j0>>=1; h>>=1;
   }
 
-  p = cur[1] + ((picture->pict_struct==BOTTOM_FIELD) ? chrom_width : 0) + i0
-             + chrom_width2*j0;
+  p = cur[1] + ((picture->pict_struct==BOTTOM_FIELD) ? enc->chrom_width : 0) + i0
+             + enc->chrom_width2*j0;
 
   for (j=0; j<h; j++)
   {
     for (i=0; i<w; i++)
       p[i] = 128;
-    p+= chrom_width2;
+    p+= enc->chrom_width2;
   }
 
-  p = cur[2] + ((picture->pict_struct==BOTTOM_FIELD) ? chrom_width : 0) + i0
-             + chrom_width2*j0;
+  p = cur[2] + ((picture->pict_struct==BOTTOM_FIELD) ? enc->chrom_width : 0) + i0
+             + enc->chrom_width2*j0;
 
   for (j=0; j<h; j++)
   {
     for (i=0; i<w; i++)
       p[i] = 128;
-    p+= chrom_width2;
+    p+= enc->chrom_width2;
   }
 }
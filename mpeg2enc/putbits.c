@@ -32,12 +32,6 @@
 #include "config.h"
 #include "global.h"
 
-extern FILE *outfile; /* the only global var we need here */
-
-/* private data */
-static unsigned char outbfr;
-static int outcnt;
-static int bytecnt;
 
 void slice_initbits(slice_engine_t *engine)
 {
@@ -111,11 +105,11 @@ void slice_finishslice(slice_engine_t *engine)
 	int i;
 	slice_alignbits(engine);
 
-	if(!fwrite(engine->slice_buffer, 1, engine->slice_size, outfile))
+	if(!fwrite(engine->slice_buffer, 1, engine->slice_size, enc->outfile))
 	{
 		perror("Write error");
 	}
-	bytecnt += engine->slice_size;
+	enc->bytecnt += engine->slice_size;
 }
 
 
@@ -123,8 +117,8 @@ void slice_finishslice(slice_engine_t *engine)
 /* initialize buffer, call once before first putbits or alignbits */
 void mpeg2_initbits()
 {
-	outcnt = 8;
-	bytecnt = 0;
+	enc->outcnt = 8;
+	enc->bytecnt = 0;
 }
 
 
@@ -140,19 +134,19 @@ int n;
 
   for (i=0; i<n; i++)
   {
-    outbfr <<= 1;
+    enc->outbfr <<= 1;
 
     if (val & mask)
-      outbfr|= 1;
+      enc->outbfr|= 1;
 
     mask >>= 1; /* select next bit */
-    outcnt--;
+    enc->outcnt--;
 
-    if (outcnt==0) /* 8 bit buffer full */
+    if (enc->outcnt==0) /* 8 bit buffer full */
     {
-      putc(outbfr,outfile);
-      outcnt = 8;
-      bytecnt++;
+      putc(enc->outbfr,enc->outfile);
+      enc->outcnt = 8;
+      enc->bytecnt++;
     }
   }
 }
@@ -160,12 +154,12 @@ int n;
 /* zero bit stuffing to next byte boundary (5.2.3, 6.2.1) */
 void alignbits()
 {
-  if (outcnt!=8)
-    mpeg2enc_putbits(0,outcnt);
+  if (enc->outcnt!=8)
+    mpeg2enc_putbits(0,enc->outcnt);
 }
 
 /* return total number of generated bits */
 double bitcount()
 {
-	return (double)8 * bytecnt + (8 - outcnt);
+	return (double)8 * enc->bytecnt + (8 - enc->outcnt);
 }
@@ -45,25 +45,25 @@ void putseqhdr()
 
   alignbits();
   mpeg2enc_putbits(SEQ_START_CODE,32); /* sequence_header_code */
-  mpeg2enc_putbits(horizontal_size,12); /* horizontal_size_value */
-  mpeg2enc_putbits(vertical_size,12); /* vertical_size_value */
-  mpeg2enc_putbits(aspectratio,4); /* aspect_ratio_information */
-  mpeg2enc_putbits(frame_rate_code,4); /* frame_rate_code */
-  mpeg2enc_putbits((int)ceil(bit_rate/400.0),18); /* bit_rate_value */
+  mpeg2enc_putbits(enc->horizontal_size,12); /* horizontal_size_value */
+  mpeg2enc_putbits(enc->vertical_size,12); /* vertical_size_value */
+  mpeg2enc_putbits(enc->aspectratio,4); /* aspect_ratio_information */
+  mpeg2enc_putbits(enc->frame_rate_code,4); /* frame_rate_code */
+  mpeg2enc_putbits((int)ceil(enc->bit_rate/400.0),18); /* bit_rate_value */
   mpeg2enc_putbits(1,1); /* marker_bit */
-  mpeg2enc_putbits(vbv_buffer_size,10); /* vbv_buffer_size_value */
-  mpeg2enc_putbits(constrparms,1); /* constrained_parameters_flag */
+  mpeg2enc_putbits(enc->vbv_buffer_size,10); /* vbv_buffer_size_value */
+  mpeg2enc_putbits(enc->constrparms,1); /* constrained_parameters_flag */
 
-  mpeg2enc_putbits(load_iquant,1); /* load_intra_quantizer_matrix */
-  if (load_iquant)
+  mpeg2enc_putbits(enc->load_iquant,1); /* load_intra_quantizer_matrix */
+  if (enc->load_iquant)
     for (i=0; i<64; i++)  /* matrices are always downloaded in zig-zag order */
-      mpeg2enc_putbits(intra_q[mpeg2_zig_zag_scan[i]],8); /* intra_quantizer_matrix */
+      mpeg2enc_putbits(enc->intra_q[mpeg2_zig_zag_scan[i]],8); /* intra_quantizer_matrix */
 
-  mpeg2enc_putbits(load_niquant,1); /* load_non_intra_quantizer_matrix */
-  if (load_niquant)
+  mpeg2enc_putbits(enc->load_niquant,1); /* load_non_intra_quantizer_matrix */
+  if (enc->load_niquant)
     for (i=0; i<64; i++)
-      mpeg2enc_putbits(inter_q[mpeg2_zig_zag_scan[i]],8); /* non_intra_quantizer_matrix */
-	if (!mpeg1)
+      mpeg2enc_putbits(enc->inter_q[mpeg2_zig_zag_scan[i]],8); /* non_intra_quantizer_matrix */
+	if (!enc->mpeg1)
 	{
 		putseqext();
 		putseqdispext();
@@ -76,14 +76,14 @@ void putseqext()
   alignbits();
   mpeg2enc_putbits(EXT_START_CODE,32); /* extension_start_code */
   mpeg2enc_putbits(SEQ_ID,4); /* extension_start_code_identifier */
-  mpeg2enc_putbits((profile<<4)|level,8); /* profile_and_level_indication */
-  mpeg2enc_putbits(prog_seq,1); /* progressive sequence */
-  mpeg2enc_putbits(chroma_format,2); /* chroma_format */
-  mpeg2enc_putbits(horizontal_size>>12,2); /* horizontal_size_extension */
-  mpeg2enc_putbits(vertical_size>>12,2); /* vertical_size_extension */
-  mpeg2enc_putbits(((int)ceil(bit_rate/400.0))>>18,12); /* bit_rate_extension */
+  mpeg2enc_putbits((enc->profile<<4)|enc->level,8); /* profile_and_level_indication */
+  mpeg2enc_putbits(enc->prog_seq,1); /* progressive sequence */
+  mpeg2enc_putbits(enc->chroma_format,2); /* chroma_format */
+  mpeg2enc_putbits(enc->horizontal_size>>12,2); /* horizontal_size_extension */
+  mpeg2enc_putbits(enc->vertical_size>>12,2); /* vertical_size_extension */
+  mpeg2enc_putbits(((int)ceil(enc->bit_rate/400.0))>>18,12); /* bit_rate_extension */
   mpeg2enc_putbits(1,1); /* marker_bit */
-  mpeg2enc_putbits(vbv_buffer_size>>10,8); /* vbv_buffer_size_extension */
+  mpeg2enc_putbits(enc->vbv_buffer_size>>10,8); /* vbv_buffer_size_extension */
   mpeg2enc_putbits(0,1); /* low_delay  -- currently not implemented */
   mpeg2enc_putbits(0,2); /* frame_rate_extension_n */
   mpeg2enc_putbits(0,5); /* frame_rate_extension_d */
@@ -98,14 +98,14 @@ void putseqdispext()
   alignbits();
   mpeg2enc_putbits(EXT_START_CODE,32); /* extension_start_code */
   mpeg2enc_putbits(DISP_ID,4); /* extension_start_code_identifier */
-  mpeg2enc_putbits(video_format,3); /* video_format */
+  mpeg2enc_putbits(enc->video_format,3); /* video_format */
   mpeg2enc_putbits(1,1); /* colour_description */
-  mpeg2enc_putbits(color_primaries,8); /* colour_primaries */
-  mpeg2enc_putbits(transfer_characteristics,8); /* transfer_characteristics */
-  mpeg2enc_putbits(matrix_coefficients,8); /* matrix_coefficients */
-  mpeg2enc_putbits(display_horizontal_size,14); /* display_horizontal_size */
+  mpeg2enc_putbits(enc->color_primaries,8); /* colour_primaries */
+  mpeg2enc_putbits(enc->transfer_characteristics,8); /* transfer_characteristics */
+  mpeg2enc_putbits(enc->matrix_coefficients,8); /* matrix_coefficients */
+  mpeg2enc_putbits(enc->display_horizontal_size,14); /* display_horizontal_size */
   mpeg2enc_putbits(1,1); /* marker_bit */
-  mpeg2enc_putbits(display_vertical_size,14); /* display_vertical_size */
+  mpeg2enc_putbits(enc->display_vertical_size,14); /* display_vertical_size */
 }
 
 /* output a zero terminated string as user data (6.2.2.2.2, 6.3.4.1)
@@ -132,7 +132,7 @@ int frame,closed_gop;
 
   alignbits();
   mpeg2enc_putbits(GOP_START_CODE,32); /* group_start_code */
-  tc = frametotc(tc0+frame);
+  tc = frametotc(enc->tc0+frame);
   mpeg2enc_putbits(tc,25); /* time_code */
   mpeg2enc_putbits(closed_gop,1); /* closed_gop */
   mpeg2enc_putbits(0,1); /* broken_link */
@@ -147,7 +147,7 @@ int frame;
 {
   int fps, pict, sec, minute, hour, tc;
 
-  fps = (int)(frame_rate+0.5);
+  fps = (int)(enc->frame_rate+0.5);
   pict = frame%fps;
   frame = (frame-pict)/fps;
   sec = frame%60;
@@ -173,7 +173,7 @@ void putpicthdr(pict_data_s *picture)
   if (picture->pict_type==P_TYPE || picture->pict_type==B_TYPE)
   {
     mpeg2enc_putbits(0,1); /* full_pel_forward_vector */
-    if (mpeg1)
+    if (enc->mpeg1)
       mpeg2enc_putbits(picture->forw_hor_f_code,3);
     else
       mpeg2enc_putbits(7,3); /* forward_f_code */
@@ -182,7 +182,7 @@ void putpicthdr(pict_data_s *picture)
   if (picture->pict_type==B_TYPE)
   {
     mpeg2enc_putbits(0,1); /* full_pel_backward_vector */
-    if (mpeg1)
+    if (enc->mpeg1)
       mpeg2enc_putbits(picture->back_hor_f_code,3);
     else
       mpeg2enc_putbits(7,3); /* backward_f_code */
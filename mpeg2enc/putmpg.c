@@ -128,7 +128,7 @@ void putmv(slice_engine_t *engine, int dmv, int f_code)
 
 /* check value */
 	if(dmv < vmin || dmv > vmax)
-    	if(!quiet)
+    	if(!enc->quiet)
     		fprintf(stderr,"invalid motion vector\n");
 
 /* split dmv into motion_code and motion_residual */
@@ -136,6 +136,7 @@ static void putmvs(slice_engine_t *engine,
 
 void* slice_engine_loop(slice_engine_t *engine)
 {
+	enc = engine->encoder;
 	while(!engine->done)
 	{
 		pthread_mutex_lock(&(engine->input_lock));
@@ -149,23 +150,23 @@ void* slice_engine_loop(slice_engine_t *engine)
 			int cbp, MBAinc = 0;
 			short (*quant_blocks)[64] = picture->qblocks;
 
-			k = engine->start_row * mb_width;
+			k = engine->start_row * enc->mb_width;
 			for(j = engine->start_row; j < engine->end_row; j++)
 			{
 /* macroblock row loop */
 //printf("putpic 1\n");
 //slice_testbits(engine);
-    			for(i = 0; i < mb_width; i++)
+    			for(i = 0; i < enc->mb_width; i++)
     			{
 					mbinfo_s *cur_mb = &picture->mbinfo[k];
-					int cur_mb_blocks = k * block_count;
+					int cur_mb_blocks = k * enc->block_count;
 //pthread_mutex_lock(&test_lock);
 /* macroblock loop */
     				if(i == 0)
     				{
 						slice_alignbits(engine);
 /* slice header (6.2.4) */
-        				if(mpeg1 || vertical_size <= 2800)
+        				if(enc->mpeg1 || enc->vertical_size <= 2800)
         					slice_putbits(engine, SLICE_MIN_START + j, 32); /* slice_start_code */
         				else
         				{
@@ -212,7 +213,7 @@ void* slice_engine_loop(slice_engine_t *engine)
 									 &cur_mb->mquant );
 
 //printf("putpic 3\n");
-						cur_mb->cbp = cbp = (1<<block_count) - 1;
+						cur_mb->cbp = cbp = (1<<enc->block_count) - 1;
     				}
     				else
     				{
@@ -236,7 +237,7 @@ void* slice_engine_loop(slice_engine_t *engine)
         				mb_type |= MB_QUANT;
 
 /* check if macroblock can be skipped */
-    				if(i != 0 && i != mb_width - 1 && !cbp)
+    				if(i != 0 && i != enc->mb_width - 1 && !cbp)
     				{
 /* no DCT coefficients and neither first nor last macroblock of slice */
 
@@ -369,18 +370,18 @@ void* slice_engine_loop(slice_engine_t *engine)
 
     				if(mb_type & MB_PATTERN)
     				{
-        				putcbp(engine, (cbp >> (block_count - 6)) & 63);
-        				if(chroma_format != CHROMA420)
-        					slice_putbits(engine, cbp, block_count - 6);
+        				putcbp(engine, (cbp >> (enc->block_count - 6)) & 63);
+        				if(enc->chroma_format != CHROMA420)
+        					slice_putbits(engine, cbp, enc->block_count - 6);
     				}
 
 //printf("putpic 4\n");
 //slice_testbits(engine);
 
-    				for(comp = 0; comp < block_count; comp++)
+    				for(comp = 0; comp < enc->block_count; comp++)
     				{
 /* block loop */
-        				if(cbp & (1 << (block_count - 1 - comp)))
+        				if(cbp & (1 << (enc->block_count - 1 - comp)))
         				{
         				  if(mb_type & MB_INTRA)
         				  {
@@ -424,43 +425,43 @@ void putpict(pict_data_s *picture)
 {
 	int i, prev_mquant;
 
-	for(i = 0; i < processors; i++)
+	for(i = 0; i < enc->processors; i++)
 	{
-		ratectl_init_pict(ratectl[i], picture); /* set up rate control */
+		ratectl_init_pict(enc->ratectl[i], picture); /* set up rate control */
 	}
 
 /* picture header and picture coding extension */
 	putpicthdr(picture);
-	if(!mpeg1) putpictcodext(picture);
+	if(!enc->mpeg1) putpictcodext(picture);
 /* Flush buffer before switching to slice mode */
 	alignbits();
 
 /* Start loop */
-	for(i = 0; i < processors; i++)
+	for(i = 0; i < enc->processors; i++)
 	{
-		slice_engines[i].prev_mquant = ratectl_start_mb(ratectl[i], picture);
-		slice_engines[i].picture = picture;
-		slice_engines[i].ratectl = ratectl[i];
-		slice_initbits(&slice_engines[i]);
+		enc->slice_engines[i].prev_mquant = ratectl_start_mb(enc->ratectl[i], picture);
+		enc->slice_engines[i].picture = picture;
+		enc->slice_engines[i].ratectl = enc->ratectl[i];
+		slice_initbits(&enc->slice_engines[i]);
 
-		pthread_mutex_unlock(&(slice_engines[i].input_lock));
+		pthread_mutex_unlock(&(enc->slice_engines[i].input_lock));
 	}
 
 /* Wait for completion and write slices */
-	for(i = 0; i < processors; i++)
+	for(i = 0; i < enc->processors; i++)
 	{
-		pthread_mutex_lock(&(slice_engines[i].output_lock));
-		slice_finishslice(&slice_engines[i]);
+		pthread_mutex_lock(&(enc->slice_engines[i].output_lock));
+		slice_finishslice(&enc->slice_engines[i]);
 	}
 
-	for(i = 0; i < processors; i++)
-		ratectl_update_pict(ratectl[i], picture);
+	for(i = 0; i < enc->processors; i++)
+		ratectl_update_pict(enc->ratectl[i], picture);
 }
 
 void start_slice_engines()
 {
 	int i;
-	int rows_per_processor = (int)((float)mb_height2 / processors + 0.5);
+	int rows_per_processor = (int)((float)enc->mb_height2 / enc->processors + 0.5);
 	int current_row = 0;
 	pthread_attr_t attr;
 	pthread_mutexattr_t mutex_attr;
@@ -469,38 +470,40 @@ void start_slice_engines()
 	pthread_attr_init(&attr);
 //	pthread_mutex_init(&test_lock, &mutex_attr);
 
-	slice_engines = calloc(1, sizeof(slice_engine_t) * processors);
-	for(i = 0; i < processors; i++)
+	enc->slice_engines = calloc(1, sizeof(slice_engine_t) * enc->processors);
+	for(i = 0; i < enc->processors; i++)
 	{
-		slice_engines[i].start_row = current_row;
+		enc->slice_engines[i].start_row = current_row;
 		current_row += rows_per_processor;
-		if(current_row > mb_height2) current_row = mb_height2;
-		slice_engines[i].end_row = current_row;
+		if(current_row > enc->mb_height2 || 
+			i == enc->processors - 1) current_row = enc->mb_height2;
+		enc->slice_engines[i].end_row = current_row;
 		
-		pthread_mutex_init(&(slice_engines[i].input_lock), &mutex_attr);
-		pthread_mutex_lock(&(slice_engines[i].input_lock));
-		pthread_mutex_init(&(slice_engines[i].output_lock), &mutex_attr);
-		pthread_mutex_lock(&(slice_engines[i].output_lock));
-		slice_engines[i].done = 0;
-		pthread_create(&(slice_engines[i].tid), 
+		pthread_mutex_init(&(enc->slice_engines[i].input_lock), &mutex_attr);
+		pthread_mutex_lock(&(enc->slice_engines[i].input_lock));
+		pthread_mutex_init(&(enc->slice_engines[i].output_lock), &mutex_attr);
+		pthread_mutex_lock(&(enc->slice_engines[i].output_lock));
+		enc->slice_engines[i].done = 0;
+		enc->slice_engines[i].encoder = enc;
+		pthread_create(&(enc->slice_engines[i].tid), 
 			&attr, 
 			(void*)slice_engine_loop, 
-			&slice_engines[i]);
+			&enc->slice_engines[i]);
 	}
 }
 
 void stop_slice_engines()
 {
 	int i;
-	for(i = 0; i < processors; i++)
+	for(i = 0; i < enc->processors; i++)
 	{
-		slice_engines[i].done = 1;
-		pthread_mutex_unlock(&(slice_engines[i].input_lock));
-		pthread_join(slice_engines[i].tid, 0);
-		pthread_mutex_destroy(&(slice_engines[i].input_lock));
-		pthread_mutex_destroy(&(slice_engines[i].output_lock));
-		if(slice_engines[i].slice_buffer) free(slice_engines[i].slice_buffer);
+		enc->slice_engines[i].done = 1;
+		pthread_mutex_unlock(&(enc->slice_engines[i].input_lock));
+		pthread_join(enc->slice_engines[i].tid, 0);
+		pthread_mutex_destroy(&(enc->slice_engines[i].input_lock));
+		pthread_mutex_destroy(&(enc->slice_engines[i].output_lock));
+		if(enc->slice_engines[i].slice_buffer) free(enc->slice_engines[i].slice_buffer);
 	}
-	free(slice_engines);
+	free(enc->slice_engines);
 //	pthread_mutex_destroy(&test_lock);
 }
@@ -43,16 +43,16 @@ void putseq()
 	int sxf = 0, sxb = 0, syf = 0, syb = 0;
 	motion_comp_s mc_data;
 
-	for(k = 0; k < processors; k++)
-		ratectl_init_seq(ratectl[k]); /* initialize rate control */
+	for(k = 0; k < enc->processors; k++)
+		ratectl_init_seq(enc->ratectl[k]); /* initialize rate control */
 
 
-	if(end_frame == 0x7fffffff)
-		frames_scaled = end_frame;
+	if(enc->end_frame == 0x7fffffff)
+		enc->frames_scaled = enc->end_frame;
 	else
-		frames_scaled = (end_frame - start_frame) * 
-			frame_rate / 
-			input_frame_rate;
+		enc->frames_scaled = (enc->end_frame - enc->start_frame) * 
+			enc->frame_rate / 
+			enc->input_frame_rate;
 //frames_scaled = 100;
 
 	/* If we're not doing sequence header, sequence extension and
@@ -60,7 +60,7 @@ void putseq()
 	   start of the sequence.
 	*/
 	
-	if(!seq_header_every_gop) putseqhdr();
+	if(!enc->seq_header_every_gop) putseqhdr();
 
 
 	/* optionally output some text data (description, copyright or whatever) */
@@ -70,22 +70,22 @@ void putseq()
 
 	/* loop through all frames in encoding/decoding order */
 	for(i = 0; 
-		i < frames_scaled; 
+		i < enc->frames_scaled && !enc->error; 
 		i++)
 	{
 //printf("putseq 1\n");
-		if(i != 0 && verbose)
+		if(i != 0 && enc->verbose)
 		{
-			if(end_frame == 0x7fffffff)
+			if(enc->end_frame == 0x7fffffff)
 				fprintf(stderr,"Encoding frame %d.  bitrate achieved: %d         \r", 
-					frame0 + i + 1, 
-					(int)((float)ftell(outfile)  / ((float)i / frame_rate)) * 8);
+					enc->frame0 + i + 1, 
+					(int)((float)ftell(enc->outfile)  / ((float)i / enc->frame_rate)) * 8);
 			else
 				fprintf(stderr,"%5d %13d%% %17d %23d        \r", 
-					frame0 + i + 1, 
-					(int)((float)i / frames_scaled * 100),
-					(int)((float)ftell(outfile)  / ((float)i / frame_rate)) * 8,
-					(int)((float)ftell(outfile)  / ((float)i / frames_scaled)));
+					enc->frame0 + i + 1, 
+					(int)((float)i / enc->frames_scaled * 100),
+					(int)((float)ftell(enc->outfile)  / ((float)i / enc->frame_rate)) * 8,
+					(int)((float)ftell(enc->outfile)  / ((float)i / enc->frames_scaled)));
 		}
 		fflush(stderr);
 
@@ -94,12 +94,12 @@ void putseq()
 		 * first GOP contains N-(M-1) frames,
 		 * all other GOPs contain N frames
 		 */
-		f0 = N*((i+(M-1))/N) - (M-1);
+		f0 = enc->N*((i+(enc->M-1))/enc->N) - (enc->M-1);
 
 		if (f0<0)
 			f0=0;
 
-		if(i == 0 || (i - 1) % M == 0)
+		if(i == 0 || (i - 1) % enc->M == 0)
 		{
 
 			/* I or P frame: Somewhat complicated buffer handling.
@@ -115,10 +115,10 @@ void putseq()
 			for (j=0; j<3; j++)
 			{
 				unsigned char *tmp;
-				oldorgframe[j] = neworgframe[j];
-				tmp = oldrefframe[j];
-				oldrefframe[j] = newrefframe[j];
-				newrefframe[j] = tmp;
+				enc->oldorgframe[j] = enc->neworgframe[j];
+				tmp = enc->oldrefframe[j];
+				enc->oldrefframe[j] = enc->newrefframe[j];
+				enc->newrefframe[j] = tmp;
 			}
 
 			/* For an I or P frame the "current frame" is simply an alias
@@ -126,66 +126,66 @@ void putseq()
 			   stuff around once the frame has been processed.
 			*/
 
-			cur_picture.curorg = neworgframe;
-			cur_picture.curref = newrefframe;
+			enc->cur_picture.curorg = enc->neworgframe;
+			enc->cur_picture.curref = enc->newrefframe;
 //printf("putseq 1 %p %p %p\n", curorg[0], curorg[1], curorg[2]);
 
 
 			/* f: frame number in display order */
-			f = (i==0) ? 0 : i+M-1;
-			if (f>=end_frame)
-				f = end_frame - 1;
+			f = (i==0) ? 0 : i+enc->M-1;
+			if (f>=enc->end_frame)
+				f = enc->end_frame - 1;
 
 			if (i==f0) /* first displayed frame in GOP is I */
 			{
 				/* I frame */
-				cur_picture.pict_type = I_TYPE;
+				enc->cur_picture.pict_type = I_TYPE;
 
-				cur_picture.forw_hor_f_code = 
-					cur_picture.forw_vert_f_code = 15;
-				cur_picture.back_hor_f_code = 
-					cur_picture.back_vert_f_code = 15;
+				enc->cur_picture.forw_hor_f_code = 
+					enc->cur_picture.forw_vert_f_code = 15;
+				enc->cur_picture.back_hor_f_code = 
+					enc->cur_picture.back_vert_f_code = 15;
 
 				/* n: number of frames in current GOP
 				 *
 				 * first GOP contains (M-1) less (B) frames
 				 */
-				n = (i==0) ? N-(M-1) : N;
+				n = (i==0) ? enc->N-(enc->M-1) : enc->N;
 
 				/* last GOP may contain less frames */
-				if (n > end_frame-f0)
-					n = end_frame-f0;
+				if (n > enc->end_frame-f0)
+					n = enc->end_frame-f0;
 
 				/* number of P frames */
 				if (i==0)
-					np = (n + 2*(M-1))/M - 1; /* first GOP */
+					np = (n + 2*(enc->M-1))/enc->M - 1; /* first GOP */
 				else
-					np = (n + (M-1))/M - 1;
+					np = (n + (enc->M-1))/enc->M - 1;
 
 				/* number of B frames */
 				nb = n - np - 1;
 
-				for(k = 0; k < processors; k++)
-					ratectl_init_GOP(ratectl[k], np, nb);
+				for(k = 0; k < enc->processors; k++)
+					ratectl_init_GOP(enc->ratectl[k], np, nb);
 				
 				/* set closed_GOP in first GOP only 
 				   No need for per-GOP seqhdr in first GOP as one
 				   has already been created.
 				 */
 //				putgophdr(f0,i==0, i!=0 && seq_header_every_gop);
-				if(seq_header_every_gop) putseqhdr();
+				if(enc->seq_header_every_gop) putseqhdr();
 				putgophdr(f0, i == 0);
 			}
 			else
 			{
 				/* P frame */
-				cur_picture.pict_type = P_TYPE;
-				cur_picture.forw_hor_f_code = motion_data[0].forw_hor_f_code;
-				cur_picture.forw_vert_f_code = motion_data[0].forw_vert_f_code;
-				cur_picture.back_hor_f_code = 
-					cur_picture.back_vert_f_code = 15;
-				sxf = motion_data[0].sxf;
-				syf = motion_data[0].syf;
+				enc->cur_picture.pict_type = P_TYPE;
+				enc->cur_picture.forw_hor_f_code = enc->motion_data[0].forw_hor_f_code;
+				enc->cur_picture.forw_vert_f_code = enc->motion_data[0].forw_vert_f_code;
+				enc->cur_picture.back_hor_f_code = 
+					enc->cur_picture.back_vert_f_code = 15;
+				sxf = enc->motion_data[0].sxf;
+				syf = enc->motion_data[0].syf;
 			}
 		}
 		else
@@ -194,72 +194,69 @@ void putseq()
 			   The current frame data pointers are a 3rd set
 			   seperate from the reference data pointers.
 			*/
-			cur_picture.curorg = auxorgframe;
-			cur_picture.curref = auxframe;
+			enc->cur_picture.curorg = enc->auxorgframe;
+			enc->cur_picture.curref = enc->auxframe;
 
 			/* f: frame number in display order */
 			f = i - 1;
-			cur_picture.pict_type = B_TYPE;
-			n = (i-2)%M + 1; /* first B: n=1, second B: n=2, ... */
-			cur_picture.forw_hor_f_code = motion_data[n].forw_hor_f_code;
-			cur_picture.forw_vert_f_code = motion_data[n].forw_vert_f_code;
-			cur_picture.back_hor_f_code = motion_data[n].back_hor_f_code;
-			cur_picture.back_vert_f_code = motion_data[n].back_vert_f_code;
-			sxf = motion_data[n].sxf;
-			syf = motion_data[n].syf;
-			sxb = motion_data[n].sxb;
-			syb = motion_data[n].syb;
+			enc->cur_picture.pict_type = B_TYPE;
+			n = (i-2)%enc->M + 1; /* first B: n=1, second B: n=2, ... */
+			enc->cur_picture.forw_hor_f_code = enc->motion_data[n].forw_hor_f_code;
+			enc->cur_picture.forw_vert_f_code = enc->motion_data[n].forw_vert_f_code;
+			enc->cur_picture.back_hor_f_code = enc->motion_data[n].back_hor_f_code;
+			enc->cur_picture.back_vert_f_code = enc->motion_data[n].back_vert_f_code;
+			sxf = enc->motion_data[n].sxf;
+			syf = enc->motion_data[n].syf;
+			sxb = enc->motion_data[n].sxb;
+			syb = enc->motion_data[n].syb;
 		}
 
-		cur_picture.temp_ref = f - f0;
-		cur_picture.frame_pred_dct = frame_pred_dct_tab[cur_picture.pict_type - 1];
-		cur_picture.q_scale_type = qscale_tab[cur_picture.pict_type - 1];
-		cur_picture.intravlc = intravlc_tab[cur_picture.pict_type - 1];
-		cur_picture.altscan = altscan_tab[cur_picture.pict_type - 1];
+		enc->cur_picture.temp_ref = f - f0;
+		enc->cur_picture.frame_pred_dct = enc->frame_pred_dct_tab[enc->cur_picture.pict_type - 1];
+		enc->cur_picture.q_scale_type = enc->qscale_tab[enc->cur_picture.pict_type - 1];
+		enc->cur_picture.intravlc = enc->intravlc_tab[enc->cur_picture.pict_type - 1];
+		enc->cur_picture.altscan = enc->altscan_tab[enc->cur_picture.pict_type - 1];
 
 //printf("putseq 2 %d\n", cur_picture.frame_pred_dct);
-		readframe(f + frame0, cur_picture.curorg);
-		if(!frames_scaled) break;
+		readframe(f + enc->frame0, enc->cur_picture.curorg);
+		if(!enc->frames_scaled) break;
 //printf("putseq 3 %p %p %p\n", curorg[0], curorg[1], curorg[2]);
 
-		mc_data.oldorg = oldorgframe;
-		mc_data.neworg = neworgframe;
-		mc_data.oldref = oldrefframe;
-		mc_data.newref = newrefframe;
-		mc_data.cur    = cur_picture.curorg;
-		mc_data.curref = cur_picture.curref;
+		mc_data.oldorg = enc->oldorgframe;
+		mc_data.neworg = enc->neworgframe;
+		mc_data.oldref = enc->oldrefframe;
+		mc_data.newref = enc->newrefframe;
+		mc_data.cur    = enc->cur_picture.curorg;
+		mc_data.curref = enc->cur_picture.curref;
 		mc_data.sxf = sxf;
 		mc_data.syf = syf;
 		mc_data.sxb = sxb;
 		mc_data.syb = syb;
 
-        if (fieldpic)
+        if (enc->fieldpic)
 		{
 //printf("putseq 4\n");
-			cur_picture.topfirst = opt_topfirst;
-			if (!quiet)
+			enc->cur_picture.topfirst = enc->opt_topfirst;
+			if (!enc->quiet)
 			{
 				fprintf(stderr,"\nfirst field  (%s) ",
-						cur_picture.topfirst ? "top" : "bot");
+						enc->cur_picture.topfirst ? "top" : "bot");
 				fflush(stderr);
 			}
 
-			cur_picture.pict_struct = cur_picture.topfirst ? TOP_FIELD : BOTTOM_FIELD;
+			enc->cur_picture.pict_struct = enc->cur_picture.topfirst ? TOP_FIELD : BOTTOM_FIELD;
 /* A.Stevens 2000: Append fast motion compensation data for new frame */
-			fast_motion_data(cur_picture.curorg[0], cur_picture.pict_struct);
-			motion_estimation(&cur_picture, &mc_data,0,0);
+			fast_motion_data(enc->cur_picture.curorg[0], enc->cur_picture.pict_struct);
+			motion_estimation(&enc->cur_picture, &mc_data,0,0);
 
-			predict(&cur_picture,oldrefframe,newrefframe,predframe,0);
-			dct_type_estimation(&cur_picture,predframe[0],cur_picture.curorg[0]);
-			transform(&cur_picture,predframe,cur_picture.curorg);
+			transform(&enc->cur_picture,enc->oldrefframe,enc->newrefframe,enc->predframe,enc->cur_picture.curorg,0);
 
-			putpict(&cur_picture);		/* Quantisation: blocks -> qblocks */
+			putpict(&enc->cur_picture);		/* Quantisation: blocks -> qblocks */
 #ifndef OUTPUT_STAT
-			if( cur_picture.pict_type!=B_TYPE)
+			if( enc->cur_picture.pict_type!=B_TYPE)
 			{
 #endif
-				iquantize( &cur_picture );
-				itransform(&cur_picture,predframe,cur_picture.curref);
+				itransform(&enc->cur_picture,enc->predframe,enc->cur_picture.curref);
 /*
  * 				calcSNR(cur_picture.curorg,cur_picture.curref);
  * 				stats();
@@ -267,41 +264,38 @@ void putseq()
 #ifndef OUTPUT_STAT
 			}
 #endif
-			if (!quiet)
+			if (!enc->quiet)
 			{
-				fprintf(stderr,"second field (%s) ",cur_picture.topfirst ? "bot" : "top");
+				fprintf(stderr,"second field (%s) ",enc->cur_picture.topfirst ? "bot" : "top");
 				fflush(stderr);
 			}
 
-			cur_picture.pict_struct = cur_picture.topfirst ? BOTTOM_FIELD : TOP_FIELD;
+			enc->cur_picture.pict_struct = enc->cur_picture.topfirst ? BOTTOM_FIELD : TOP_FIELD;
 
-			ipflag = (cur_picture.pict_type==I_TYPE);
+			ipflag = (enc->cur_picture.pict_type==I_TYPE);
 			if (ipflag)
 			{
 				/* first field = I, second field = P */
-				cur_picture.pict_type = P_TYPE;
-				cur_picture.forw_hor_f_code = motion_data[0].forw_hor_f_code;
-				cur_picture.forw_vert_f_code = motion_data[0].forw_vert_f_code;
-				cur_picture.back_hor_f_code = 
-					cur_picture.back_vert_f_code = 15;
-				sxf = motion_data[0].sxf;
-				syf = motion_data[0].syf;
+				enc->cur_picture.pict_type = P_TYPE;
+				enc->cur_picture.forw_hor_f_code = enc->motion_data[0].forw_hor_f_code;
+				enc->cur_picture.forw_vert_f_code = enc->motion_data[0].forw_vert_f_code;
+				enc->cur_picture.back_hor_f_code = 
+					enc->cur_picture.back_vert_f_code = 15;
+				sxf = enc->motion_data[0].sxf;
+				syf = enc->motion_data[0].syf;
 			}
 
-			motion_estimation(&cur_picture, &mc_data ,1,ipflag);
+			motion_estimation(&enc->cur_picture, &mc_data ,1,ipflag);
 
-			predict(&cur_picture,oldrefframe,newrefframe,predframe,1);
-			dct_type_estimation(&cur_picture,predframe[0],cur_picture.curorg[0]);
-			transform(&cur_picture,predframe,cur_picture.curorg);
+			transform(&enc->cur_picture,enc->oldrefframe,enc->newrefframe,enc->predframe,enc->cur_picture.curorg,1);
 
-			putpict(&cur_picture);	/* Quantisation: blocks -> qblocks */
+			putpict(&enc->cur_picture);	/* Quantisation: blocks -> qblocks */
 
 #ifndef OUTPUT_STAT
-			if( cur_picture.pict_type!=B_TYPE)
+			if( enc->cur_picture.pict_type!=B_TYPE)
 			{
 #endif
-				iquantize( &cur_picture );
-				itransform(&cur_picture,predframe,cur_picture.curref);
+				itransform(&enc->cur_picture,enc->predframe,enc->cur_picture.curref);
 /*
  * 				calcSNR(cur_picture.curorg,cur_picture.curref);
  * 				stats();
@@ -314,8 +308,8 @@ void putseq()
 		else
 		{
 //printf("putseq 5\n");
-			cur_picture.pict_struct = FRAME_PICTURE;
-			fast_motion_data(cur_picture.curorg[0], cur_picture.pict_struct);
+			enc->cur_picture.pict_struct = FRAME_PICTURE;
+			fast_motion_data(enc->cur_picture.curorg[0], enc->cur_picture.pict_struct);
 //printf("putseq 5\n");
 
 /* do motion_estimation
@@ -324,28 +318,21 @@ void putseq()
  * and reconstructed frames (...refframe) for half pel search
  */
 
-			motion_estimation(&cur_picture,&mc_data,0,0);
+			motion_estimation(&enc->cur_picture,&mc_data,0,0);
 
 //printf("putseq 5\n");
-			predict(&cur_picture, oldrefframe,newrefframe,predframe,0);
-//printf("putseq 5\n");
-			dct_type_estimation(&cur_picture,predframe[0],cur_picture.curorg[0]);
-//printf("putseq 5\n");
-
-			transform(&cur_picture,predframe,cur_picture.curorg);
+			transform(&enc->cur_picture,enc->oldrefframe,enc->newrefframe,enc->predframe,enc->cur_picture.curorg,0);
 //printf("putseq 5\n");
 
 /* Side-effect: quantisation blocks -> qblocks */
-			putpict(&cur_picture);	
+			putpict(&enc->cur_picture);	
 //printf("putseq 6\n");
 
 #ifndef OUTPUT_STAT
-			if( cur_picture.pict_type!=B_TYPE)
+			if( enc->cur_picture.pict_type!=B_TYPE)
 			{
 #endif
-				iquantize( &cur_picture );
-//printf("putseq 5\n");
-				itransform(&cur_picture,predframe,cur_picture.curref);
+				itransform(&enc->cur_picture,enc->predframe,enc->cur_picture.curref);
 //printf("putseq 6\n");
 /*
  * 				calcSNR(cur_picture.curorg,cur_picture.curref);
@@ -355,10 +342,10 @@ void putseq()
 			}
 #endif
 		}
-		writeframe(f + frame0, cur_picture.curref);
+		writeframe(f + enc->frame0, enc->cur_picture.curref);
 			
 //printf("putseq 7\n");
 	}
 	putseqend();
-  	if(verbose) fprintf(stderr, "\nDone.  Be sure to visit heroinewarrior.com for updates.\n");
+  	if(enc->verbose) fprintf(stderr, "\nDone.  Be sure to visit heroinewarrior.com for updates.\n");
 }
@@ -40,11 +40,11 @@ static void putDC(slice_engine_t *engine, sVLCtable *tab, int val)
 
 	absval = (val < 0) ? -val : val;
 
-	if(absval > dctsatlim)
+	if(absval > enc->dctsatlim)
 	{
 /* should never happen */
-    	sprintf(errortext,"DC value out of range (%d)\n",val);
-    	error(errortext);
+    	sprintf(enc->errortext,"DC value out of range (%d)\n",val);
+    	error(enc->errortext);
 	}
 
 /* compute dct_dc_size */
@@ -95,11 +95,11 @@ void putAC(slice_engine_t *engine, int run, int signed_level, int vlcformat)
 	level = (signed_level < 0) ? -signed_level : signed_level; /* abs(signed_level) */
 
 /* make sure run and level are valid */
-	if(run < 0 || run > 63 || level == 0 || level > dctsatlim)
+	if(run < 0 || run > 63 || level == 0 || level > enc->dctsatlim)
 	{
-    	sprintf(errortext,"AC value out of range (run=%d, signed_level=%d)\n",
+    	sprintf(enc->errortext,"AC value out of range (run=%d, signed_level=%d)\n",
     		run,signed_level);
-    	error(errortext);
+    	error(enc->errortext);
 	}
 
 	len = 0;
@@ -136,7 +136,7 @@ void putAC(slice_engine_t *engine, int run, int signed_level, int vlcformat)
 /* no VLC for this (run, level) combination: use escape coding (7.2.2.3) */
     	slice_putbits(engine, 1l, 6); /* Escape */
     	slice_putbits(engine, run, 6); /* 6 bit code for run */
-    	if(mpeg1)
+    	if(enc->mpeg1)
     	{
 /* ISO/IEC 11172-2 uses a 8 or 16 bit code */
     		if (signed_level > 127)
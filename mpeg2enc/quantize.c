@@ -63,10 +63,10 @@ void init_quantizer_hv()
 #ifdef X86_CPU
   if( (flags & ACCEL_X86_MMX) != 0 ) /* MMX CPU */
 	{
-		if(verbose) fprintf( stderr, "SETTING " );
+		if(enc->verbose) fprintf( stderr, "SETTING " );
 		if( (flags & ACCEL_X86_3DNOW) != 0 )
 		{
-			if(verbose) fprintf( stderr, "3DNOW and ");
+			if(enc->verbose) fprintf( stderr, "3DNOW and ");
 			pquant_non_intra = quant_non_intra_hv_3dnow;
 		}
 /*
@@ -83,17 +83,17 @@ void init_quantizer_hv()
 
 		if ( (flags & ACCEL_X86_MMXEXT) != 0 )
 		{
-			if(verbose) fprintf( stderr, "EXTENDED MMX");
+			if(enc->verbose) fprintf( stderr, "EXTENDED MMX");
 			pquant_weight_coeff_sum = quant_weight_coeff_sum_mmx;
 			piquant_non_intra_m1 = iquant_non_intra_m1_sse;
 		}
 		else
 		{
-			if(verbose) fprintf( stderr, "MMX");
+			if(enc->verbose) fprintf( stderr, "MMX");
 			pquant_weight_coeff_sum = quant_weight_coeff_sum_mmx;
 			piquant_non_intra_m1 = iquant_non_intra_m1_mmx;
 		}
-		if(verbose) fprintf( stderr, " for QUANTIZER!\n");
+		if(enc->verbose) fprintf( stderr, " for QUANTIZER!\n");
 	}
   else
 #endif
@@ -158,8 +158,8 @@ void quant_intra_hv(
   int i,comp;
   int x, y, d;
   int clipping;
-  int clipvalue  = dctsatlim;
-  uint16_t *quant_mat = intra_q_tbl[mquant] /* intra_q */;
+  int clipvalue  = enc->dctsatlim;
+  uint16_t *quant_mat = enc->intra_q_tbl[mquant] /* intra_q */;
 
 
   /* Inspired by suggestion by Juan.  Quantize a little harder if we clip...
@@ -170,7 +170,7 @@ void quant_intra_hv(
 	  clipping = 0;
 	  pbuf = dst;
 	  psrc = src;
-	  for( comp = 0; comp<block_count && !clipping; ++comp )
+	  for( comp = 0; comp<enc->block_count && !clipping; ++comp )
 	  {
 		x = psrc[0];
 		d = 8>>picture->dc_prec; /* intra_dc_mult */
@@ -187,7 +187,7 @@ void quant_intra_hv(
 			  {
 				clipping = 1;
 				mquant = next_larger_quant_hv( picture, mquant );
-				quant_mat = intra_q_tbl[mquant];
+				quant_mat = enc->intra_q_tbl[mquant];
 				break;
 			  }
 		  
@@ -254,12 +254,12 @@ int quant_non_intra_hv(
 	int x, y, d;
 	int nzflag;
 	int coeff_count;
-	int clipvalue  = dctsatlim;
+	int clipvalue  = enc->dctsatlim;
 	int flags = 0;
 	int saturated = 0;
-	uint16_t *quant_mat = inter_q_tbl[mquant]/* inter_q */;
+	uint16_t *quant_mat = enc->inter_q_tbl[mquant]/* inter_q */;
 	
-	coeff_count = 64*block_count;
+	coeff_count = 64*enc->block_count;
 	flags = 0;
 	nzflag = 0;
 	for (i=0; i<coeff_count; ++i)
@@ -294,7 +294,7 @@ restart:
 				if( new_mquant != mquant )
 				{
 					mquant = new_mquant;
-					quant_mat = inter_q_tbl[mquant];
+					quant_mat = enc->inter_q_tbl[mquant];
 				}
 				else
 				{
@@ -318,7 +318,7 @@ restart:
 static void iquant1_intra(int16_t *src, int16_t *dst, int dc_prec, int mquant)
 {
   int i, val;
-  uint16_t *quant_mat = intra_q;
+  uint16_t *quant_mat = enc->intra_q;
 
   dst[0] = src[0] << (3-dc_prec);
   for (i=1; i<64; i++)
@@ -340,14 +340,14 @@ void iquant_intra(int16_t *src, int16_t *dst, int dc_prec, int mquant)
 {
   int i, val, sum;
 
-  if ( mpeg1  )
+  if ( enc->mpeg1  )
     iquant1_intra(src,dst,dc_prec, mquant);
   else
   {
     sum = dst[0] = src[0] << (3-dc_prec);
     for (i=1; i<64; i++)
     {
-      val = (int)(src[i]*intra_q[i]*mquant)/16;
+      val = (int)(src[i]*enc->intra_q[i]*mquant)/16;
       sum+= dst[i] = (val>2047) ? 2047 : ((val<-2048) ? -2048 : val);
     }
 
@@ -406,8 +406,8 @@ void iquant_non_intra(int16_t *src, int16_t *dst, int mquant )
   int i, val, sum;
   uint16_t *quant_mat;
 
-  if ( mpeg1 )
-    (*piquant_non_intra_m1)(src,dst,inter_q_tbl[mquant]);
+  if ( enc->mpeg1 )
+    (*piquant_non_intra_m1)(src,dst,enc->inter_q_tbl[mquant]);
   else
   {
 	  sum = 0;
@@ -418,11 +418,11 @@ void iquant_non_intra(int16_t *src, int16_t *dst, int mquant )
 		  val = src[i];
 		  if (val!=0)
 			  
-			  val = (int)((2*val+(val>0 ? 1 : -1))*inter_q[i]*mquant)/32;
+			  val = (int)((2*val+(val>0 ? 1 : -1))*enc->inter_q[i]*mquant)/32;
 		  sum+= dst[i] = (val>2047) ? 2047 : ((val<-2048) ? -2048 : val);
 	  }
 #else
-	  quant_mat = inter_q_tbl[mquant];
+	  quant_mat = enc->inter_q_tbl[mquant];
 	  for (i=0; i<64; i++)
 	  {
 		  val = src[i];
@@ -444,21 +444,28 @@ void iquant_non_intra(int16_t *src, int16_t *dst, int mquant )
 }
 
 void iquantize( pict_data_s *picture )
+{
+	iquantize_rows(picture, 0, enc->height2);
+}
+
+/* Inverse quantise the macroblock rows from start_row to end_row */
+void iquantize_rows( pict_data_s *picture, int start_row, int end_row )
 {
 	int j,k;
 	int16_t (*qblocks)[64] = picture->qblocks;
-	for (k=0; k<mb_per_pict; k++)
+	int end_mb = (end_row / 16) * (enc->width / 16);
+	for (k=(start_row / 16) * (enc->width / 16); k<end_mb; k++)
 	{
 		if (picture->mbinfo[k].mb_type & MB_INTRA)
-			for (j=0; j<block_count; j++)
-				iquant_intra(qblocks[k*block_count+j],
-							 qblocks[k*block_count+j],
-							 cur_picture.dc_prec,
-							 cur_picture.mbinfo[k].mquant);
+			for (j=0; j<enc->block_count; j++)
+				iquant_intra(qblocks[k*enc->block_count+j],
+							 qblocks[k*enc->block_count+j],
+							 picture->dc_prec,
+							 picture->mbinfo[k].mquant);
 		else
-			for (j=0;j<block_count;j++)
-				iquant_non_intra(qblocks[k*block_count+j],
-								 qblocks[k*block_count+j],
-								 cur_picture.mbinfo[k].mquant);
+			for (j=0;j<enc->block_count;j++)
+				iquant_non_intra(qblocks[k*enc->block_count+j],
+								 qblocks[k*enc->block_count+j],
+								 picture->mbinfo[k].mquant);
 	}
 }
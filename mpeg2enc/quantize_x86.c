@@ -78,9 +78,9 @@ int quant_non_intra_hv_3dnow(
 	int *nonsat_mquant)
 {
 	int saturated;
-	int satlim = dctsatlim;
+	int satlim = enc->dctsatlim;
 	float *i_quant_matf; 
-	int   coeff_count = 64*block_count;
+	int   coeff_count = 64*enc->block_count;
 	uint32_t nzflag, flags;
 	int16_t *psrc, *pdst;
 	float *piqf;
@@ -97,7 +97,7 @@ int quant_non_intra_hv_3dnow(
 	punpcklwd_r2r( mm1, mm1 );
 	punpckldq_r2r( mm1, mm1 );
 restart:
-	i_quant_matf = i_inter_q_tblf[mquant];
+	i_quant_matf = enc->i_inter_q_tblf[mquant];
 	flags = 0;
 	piqf = i_quant_matf;
 	saturated = 0;
@@ -228,9 +228,9 @@ int quant_non_intra_hv_sse(
 	int *nonsat_mquant)
 {
 	int saturated;
-	int satlim = dctsatlim;
+	int satlim = enc->dctsatlim;
 	float *i_quant_matf; 
-	int   coeff_count = 64*block_count;
+	int   coeff_count = 64*enc->block_count;
 	uint32_t nzflag, flags;
 	int16_t *psrc, *pdst;
 	float *piqf;
@@ -250,7 +250,7 @@ int quant_non_intra_hv_sse(
 	punpcklwd_r2r( mm1, mm1 );
 	punpckldq_r2r( mm1, mm1 );
 restart:
-	i_quant_matf = i_inter_q_tblf[mquant];
+	i_quant_matf = enc->i_inter_q_tblf[mquant];
 	flags = 0;
 	piqf = i_quant_matf;
 	saturated = 0;
@@ -370,12 +370,12 @@ int quant_non_intra_hv_mmx(
 {
 
 	int nzflag;
-	int clipvalue  = dctsatlim;
+	int clipvalue  = enc->dctsatlim;
 	int flags = 0;
 	int saturated = 0;
-	uint16_t *quant_mat = inter_q;
+	uint16_t *quant_mat = enc->inter_q;
 	int comp;
-	uint16_t *i_quant_mat = i_inter_q;
+	uint16_t *i_quant_mat = enc->i_inter_q;
 	int imquant;
 	int16_t *psrc, *pdst;
 
@@ -437,7 +437,7 @@ int quant_non_intra_hv_mmx(
 			non 32-bit int machines ;-)) if out of dynamic range for MMX...
 		*/
 	}
-	while( comp < block_count  && (flags & 0xff) == 0  );
+	while( comp < enc->block_count  && (flags & 0xff) == 0  );
 
 
 	/* Coefficient out of range or can't avoid saturation:
@@ -455,7 +455,7 @@ int quant_non_intra_hv_mmx(
 void iquant1_intra(int16_t *src, int16_t *dst, int dc_prec, int mquant)
 {
   int i, val;
-  uint16_t *quant_mat = intra_q;
+  uint16_t *quant_mat = enc->intra_q;
 
   dst[0] = src[0] << (3-dc_prec);
   for (i=1; i<64; i++)
@@ -60,14 +60,14 @@ void ratectl_init_seq(ratectl_t *ratectl)
 	ratectl->avg_KB = 10.0;   /* for MPEG-1, may need tuning for MPEG-2   */
 	ratectl->avg_KP = 10.0;
 
-	ratectl->bits_per_mb = (double)bit_rate / (mb_per_pict);
+	ratectl->bits_per_mb = (double)enc->bit_rate / (enc->mb_per_pict);
 	/* reaction parameter (constant) decreased to increase response
 	   rate as encoder is currently tending to under/over-shoot... in
 	   rate TODO: Reaction parameter is *same* for every frame type
 	   despite different weightings...  */
 
 	if (ratectl->r == 0)  
-		ratectl->r = (int)floor(2.0 * bit_rate / frame_rate + 0.5);
+		ratectl->r = (int)floor(2.0 * enc->bit_rate / enc->frame_rate + 0.5);
 
 	ratectl->Ki = 1.2;  /* EXPERIMENT: ADJUST activities for I MB's */
 	ratectl->Kb = 1.4;
@@ -88,13 +88,13 @@ void ratectl_init_seq(ratectl_t *ratectl)
 	*/
 
 	ratectl->CarryR = 0;
-	ratectl->CarryRLim = video_buffer_size / 3;
+	ratectl->CarryRLim = enc->video_buffer_size / 3;
 	/* global complexity (Chi! not X!) measure of different frame types */
 	/* These are just some sort-of sensible initial values for start-up */
 
-	ratectl->Xi = 1500*mb_per_pict;   /* Empirically derived values */
-	ratectl->Xp = 550*mb_per_pict;
-	ratectl->Xb = 170*mb_per_pict;
+	ratectl->Xi = 1500*enc->mb_per_pict;   /* Empirically derived values */
+	ratectl->Xp = 550*enc->mb_per_pict;
+	ratectl->Xb = 170*enc->mb_per_pict;
 	ratectl->d0i = -1;				/* Force initial Quant prediction */
 	ratectl->d0pb = -1;
 
@@ -104,7 +104,7 @@ void ratectl_init_seq(ratectl_t *ratectl)
 void ratectl_init_GOP(ratectl_t *ratectl, int np, int nb)
 {
 	double per_gop_bits = 
-		(double)(1 + np + nb) * (double)bit_rate / frame_rate;
+		(double)(1 + np + nb) * (double)enc->bit_rate / enc->frame_rate;
 
 	/* A.Stevens Aug 2000: at last I've found the wretched
 	   rate-control overshoot bug...  Simply "topping up" R here means
@@ -137,7 +137,7 @@ void ratectl_init_GOP(ratectl_t *ratectl, int np, int nb)
 		   *exact* value and use that for calculating how much we
 		   may "carry over"
 		*/
-		ratectl->gop_undershoot = intmin( video_buffer_size/2, (int)ratectl->R );
+		ratectl->gop_undershoot = intmin( enc->video_buffer_size/2, (int)ratectl->R );
 
 		ratectl->R = ratectl->gop_undershoot + per_gop_bits;		
 	}
@@ -148,8 +148,8 @@ void ratectl_init_GOP(ratectl_t *ratectl, int np, int nb)
 		ratectl->gop_undershoot = 0;
 	}
 	ratectl->IR = ratectl->R;
-	ratectl->Np = fieldpic ? 2 * np + 1 : np;
-	ratectl->Nb = fieldpic ? 2 * nb : nb;
+	ratectl->Np = enc->fieldpic ? 2 * np + 1 : np;
+	ratectl->Nb = enc->fieldpic ? 2 * nb : nb;
 }
 
 static int scale_quant(pict_data_s *picture, double quant )
@@ -221,8 +221,8 @@ static double calc_actj(pict_data_s *picture)
 	sum = 0.0;
 	k = 0;
 
-	for (j=0; j<height2; j+=16)
-		for (i=0; i<width; i+=16)
+	for (j=0; j<enc->height2; j+=16)
+		for (i=0; i<enc->width; i+=16)
 		{
 			/* A.Stevens Jul 2000 Luminance variance *has* to be a rotten measure
 			   of how active a block in terms of bits needed to code a lossless DCT.
@@ -234,7 +234,7 @@ static double calc_actj(pict_data_s *picture)
 			*/
 			if( picture->mbinfo[k].mb_type  & MB_INTRA )
 			{
-				i_q_mat = i_intra_q;
+				i_q_mat = enc->i_intra_q;
 				/* EXPERIMENT: See what happens if we compensate for
 				 the wholly disproprotionate weight of the DC
 				 coefficients.  Shold produce more sensible results...  */
@@ -242,7 +242,7 @@ static double calc_actj(pict_data_s *picture)
 			}
 			else
 			{
-				i_q_mat = i_inter_q;
+				i_q_mat = enc->i_inter_q;
 				actsum = 0;
 			}
 
@@ -256,7 +256,7 @@ static double calc_actj(pict_data_s *picture)
 			for( l = 0; l < 6; ++l )
 				actsum += 
 					(*pquant_weight_coeff_sum)
-					    ( cur_picture.mbinfo[k].dctblocks[l], i_q_mat ) ;
+					    ( enc->cur_picture.mbinfo[k].dctblocks[l], i_q_mat ) ;
 			actj = (double)actsum / (double)COEFFSUM_SCALE;
 			if( actj < 12.0 )
 				actj = 12.0;
@@ -293,7 +293,7 @@ void ratectl_init_pict(ratectl_t *ratectl, pict_data_s *picture)
 	*/
 
 	ratectl->actsum =  calc_actj(picture );
-	ratectl->avg_act = (double)ratectl->actsum/(double)(mb_per_pict);
+	ratectl->avg_act = (double)ratectl->actsum/(double)(enc->mb_per_pict);
 	ratectl->sum_avg_act += ratectl->avg_act;
 	ratectl->actcovered = 0.0;
 
@@ -345,10 +345,10 @@ void ratectl_init_pict(ratectl_t *ratectl, pict_data_s *picture)
 		ratectl->T = 4000.0;
 	}
 	target_Q = scale_quant(picture, 
-						   avg_K * ratectl->avg_act *(mb_per_pict) / ratectl->T);
+						   avg_K * ratectl->avg_act *(enc->mb_per_pict) / ratectl->T);
 	current_Q = scale_quant(picture,62.0*ratectl->d / ratectl->r);
 #ifdef DEBUG
-	if( !quiet )
+	if( !enc->quiet )
 	{
 		/* printf( "AA=%3.4f T=%6.0f K=%.1f ",avg_act, (double)T, avg_K  ); */
 		printf( "AA=%3.4f SA==%3.4f ",avg_act, sum_avg_act  ); 
@@ -376,14 +376,14 @@ int ratectl_start_mb(ratectl_t *ratectl, pict_data_s *picture)
 	double Qj;
 	int mquant;
 	
-	if(fixed_mquant) 
-		Qj = fixed_mquant;
+	if(enc->fixed_mquant) 
+		Qj = enc->fixed_mquant;
 	else
 		Qj = ratectl->current_quant;
 //		Qj = ratectl->d * 62.0 / ratectl->r;
 
 	mquant = scale_quant( picture, Qj);
-	mquant = intmax(mquant, quant_floor);
+	mquant = intmax(mquant, enc->quant_floor);
 
 	return mquant;
 }
@@ -401,7 +401,7 @@ void ratectl_update_pict(ratectl_t *ratectl, pict_data_s *picture)
 	double new_weight;
 	double old_weight;
 	
-	if(fixed_mquant) return;
+	if(enc->fixed_mquant) return;
 	
 	AP = bitcount() - ratectl->S;
 	frame_overshoot = (int)AP-(int)ratectl->T;
@@ -418,11 +418,11 @@ void ratectl_update_pict(ratectl_t *ratectl, pict_data_s *picture)
 
 	 */
 
-	if( ratectl->gop_undershoot-frame_overshoot > video_buffer_size/2 )
+	if( ratectl->gop_undershoot-frame_overshoot > enc->video_buffer_size/2 )
 	{
 		int padding_bytes = 
-			((ratectl->gop_undershoot - frame_overshoot) - video_buffer_size/2)/8;
-		if( quant_floor != 0 )	/* VBR case pretend to pad */
+			((ratectl->gop_undershoot - frame_overshoot) - enc->video_buffer_size/2)/8;
+		if( enc->quant_floor != 0 )	/* VBR case pretend to pad */
 		{
 			PP = AP + padding_bytes;
 		}
@@ -452,13 +452,13 @@ void ratectl_update_pict(ratectl_t *ratectl, pict_data_s *picture)
 	ratectl->R -= PP;						/* remaining # of bits in GOP */
 
 	Qsum = 0;
-	for( i = 0; i < mb_per_pict; ++i )
+	for( i = 0; i < enc->mb_per_pict; ++i )
 	{
 		Qsum += picture->mbinfo[i].mquant;
 	}
 
 
-	ratectl->AQ = (double)Qsum/(double)mb_per_pict;
+	ratectl->AQ = (double)Qsum/(double)enc->mb_per_pict;
 	/* TODO: The X are used as relative activity measures... so why
 	   bother dividing by 2?  
 	   Note we have to be careful to measure the actual data not the
@@ -469,7 +469,7 @@ void ratectl_update_pict(ratectl_t *ratectl, pict_data_s *picture)
 	
 	K = X / ratectl->actsum;
 #ifdef DEBUG
-	if( !quiet )
+	if( !enc->quiet )
 	{
 		printf( "AQ=%.1f SQ=%.2f",  AQ,SQ);
 	}
@@ -520,18 +520,18 @@ void ratectl_update_pict(ratectl_t *ratectl, pict_data_s *picture)
 	ratectl->frame_end = bitcount();
 
 	last_size = ratectl->frame_end - ratectl->frame_start;
-	avg_bitrate = (double)last_size * frame_rate;
+	avg_bitrate = (double)last_size * enc->frame_rate;
 	switch(picture->pict_type)
 	{
 		case I_TYPE:
-			new_weight = avg_bitrate / bit_rate * 1 / N;
-			old_weight = (double)(N - 1) / N;
+			new_weight = avg_bitrate / enc->bit_rate * 1 / enc->N;
+			old_weight = (double)(enc->N - 1) / enc->N;
 			break;
 
 		default:
 		case P_TYPE:
-			new_weight = avg_bitrate / bit_rate * (N - 1) / N;
-			old_weight = (double)1 / N;
+			new_weight = avg_bitrate / enc->bit_rate * (enc->N - 1) / enc->N;
+			old_weight = (double)1 / enc->N;
 			break;
 	}
 	ratectl->current_quant *= (old_weight + new_weight);
@@ -580,12 +580,12 @@ int ratectl_calc_mquant(ratectl_t *ratectl, pict_data_s *picture, int j)
 	Qj = dj * 62.0 / ratectl->r;
 
 //printf("ratectl_calc_mquant %f\n", Qj);
-	if(fixed_mquant)
-		Qj = fixed_mquant;
+	if(enc->fixed_mquant)
+		Qj = enc->fixed_mquant;
 	else
 		Qj = ratectl->current_quant;
 
-	Qj = (Qj > quant_floor) ? Qj : quant_floor;
+	Qj = (Qj > enc->quant_floor) ? Qj : enc->quant_floor;
 	/*  Heuristic: Decrease quantisation for blocks with lots of
 		sizeable coefficients.  We assume we just get a mess if
 		a complex texture's coefficients get chopped...
@@ -593,8 +593,8 @@ int ratectl_calc_mquant(ratectl_t *ratectl, pict_data_s *picture, int j)
 		
 	N_actj =  actj < ratectl->avg_act ? 
 		1.0 : 
-		(actj + act_boost * ratectl->avg_act) /
-		(act_boost * actj + ratectl->avg_act);
+		(actj + enc->act_boost * ratectl->avg_act) /
+		(enc->act_boost * actj + ratectl->avg_act);
    
 	mquant = scale_quant(picture, Qj * N_actj);
 
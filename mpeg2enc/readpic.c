@@ -45,7 +45,6 @@ long number;
 	double cr, cg, cb, cu, cv;
 	char name[128];
 	unsigned char *yp, *up, *vp;
-	static unsigned char *u444, *v444, *u422, *v422;
 	static double coef[7][3] = {
 		{0.2125,0.7154,0.0721}, /* ITU-R Rec. 709 (1990) */
 		{0.299, 0.587, 0.114},  /* unspecified */
@@ -61,7 +60,7 @@ long number;
 	int colormodel;
 	long real_number;
 
-	i = matrix_coefficients;
+	i = enc->matrix_coefficients;
 	if(i > 8) i = 3;
 
 	cr = coef[i - 1][0];
@@ -71,25 +70,25 @@ long number;
 	cv = 0.5 / (1.0 - cr);
 
 // Allocate output buffers
-	if(chroma_format == CHROMA444)
+	if(enc->chroma_format == CHROMA444)
 	{
 // Not supported by libMPEG3
-    	u444 = frame[1];
-    	v444 = frame[2];
+    	enc->u444 = frame[1];
+    	enc->v444 = frame[2];
 	}
 	else
 	{
-    	if (!u444)
+    	if (!enc->u444)
     	{
-    		if (!(u444 = (unsigned char *)malloc(width*height)))
+    		if (!(enc->u444 = (unsigned char *)malloc(enc->width*enc->height)))
         		error("malloc failed");
-    		if (!(v444 = (unsigned char *)malloc(width*height)))
+    		if (!(enc->v444 = (unsigned char *)malloc(enc->width*enc->height)))
         		error("malloc failed");
-    		if (chroma_format==CHROMA420)
+    		if (enc->chroma_format==CHROMA420)
     		{
-        		if (!(u422 = (unsigned char *)malloc((width>>1)*height)))
+        		if (!(enc->u422 = (unsigned char *)malloc((enc->width>>1)*enc->height)))
         			error("malloc failed");
-        		if (!(v422 = (unsigned char *)malloc((width>>1)*height)))
+        		if (!(enc->v422 = (unsigned char *)malloc((enc->width>>1)*enc->height)))
         			error("malloc failed");
     		}
     	}
@@ -115,26 +114,26 @@ long number;
 		need_tables = 0;
 	}
 
-	real_number = (long)((double)quicktime_frame_rate(qt_file, 0) / 
-			frame_rate * 
+	real_number = (long)((double)quicktime_frame_rate(enc->qt_file, 0) / 
+			enc->frame_rate * 
 			number + 
 			0.5);
-	quicktime_set_video_position(qt_file, 
+	quicktime_set_video_position(enc->qt_file, 
 		real_number, 
 		0);
 
 //printf("readframe 1 %d %d\n", width, height);
-	quicktime_set_row_span(qt_file, width);
-	quicktime_set_window(qt_file,
+	quicktime_set_row_span(enc->qt_file, enc->width);
+	quicktime_set_window(enc->qt_file,
 		0, 
 		0,
-		horizontal_size,
-		vertical_size,
-		horizontal_size,
-		vertical_size);
-	quicktime_set_cmodel(qt_file, (chroma_format == 1) ? BC_YUV420P : BC_YUV422P);
+		enc->horizontal_size,
+		enc->vertical_size,
+		enc->horizontal_size,
+		enc->vertical_size);
+	quicktime_set_cmodel(enc->qt_file, (enc->chroma_format == 1) ? BC_YUV420P : BC_YUV422P);
 	
-	quicktime_decode_video(qt_file, 
+	quicktime_decode_video(enc->qt_file, 
 		frame, 
 		0);
 //printf("readframe 2\n");
@@ -147,23 +146,23 @@ static void read_mpeg(long number, unsigned char *frame[])
 	long real_number;
 
 // Normalize frame_rate
-	real_number = (long)((double)mpeg3_frame_rate(mpeg_file, 0) / 
-		frame_rate * 
+	real_number = (long)((double)mpeg3_frame_rate(enc->mpeg_file, 0) / 
+		enc->frame_rate * 
 		number + 
 		0.5);
 
-	while(mpeg3_get_frame(mpeg_file, 0) <= real_number)
-		mpeg3_read_yuvframe(mpeg_file,
+	while(mpeg3_get_frame(enc->mpeg_file, 0) <= real_number)
+		mpeg3_read_yuvframe(enc->mpeg_file,
 			frame[0],
 			frame[1],
 			frame[2],
 			0,
 			0,
-			horizontal_size,
-			vertical_size,
+			enc->horizontal_size,
+			enc->vertical_size,
 			0);
 /* Terminate encoding after processing this frame */
-	if(mpeg3_end_of_video(mpeg_file, 0)) frames_scaled = 1; 
+	if(mpeg3_end_of_video(enc->mpeg_file, 0)) enc->frames_scaled = 1; 
 }
 
 static void read_stdin(long number, unsigned char *frame[])
@@ -172,25 +171,25 @@ static void read_stdin(long number, unsigned char *frame[])
 	unsigned char data[5];
 
 
-	if(chroma_format == 1) chroma_denominator = 2;
+	if(enc->chroma_format == 1) chroma_denominator = 2;
 
-	if(fread(data, 4, 1, stdin_fd) < 1)
+	if(fread(data, 4, 1, enc->stdin_fd) < 1)
 		goto read_error;
 
 // Terminate encoding before processing this frame
 	if(data[0] == 0xff && data[1] == 0xff && data[2] == 0xff && data[3] == 0xff)
 	{
-		frames_scaled = 0;
+		enc->frames_scaled = 0;
 		return;
 	}
 
-	if(fread(frame[0], width * height, 1, stdin_fd) < 1 ||
-		fread(frame[1], width / 2 * height / chroma_denominator, 1, stdin_fd) < 1 ||
-		fread(frame[2], width / 2 * height / chroma_denominator, 1, stdin_fd))
+	if(fread(frame[0], enc->width * enc->height, 1, enc->stdin_fd) < 1 ||
+		fread(frame[1], enc->width / 2 * enc->height / chroma_denominator, 1, enc->stdin_fd) < 1 ||
+		fread(frame[2], enc->width / 2 * enc->height / chroma_denominator, 1, enc->stdin_fd))
 	{
 read_error:
 		fprintf(stderr, "Failed to read frame from stdin\n");
-		frames_scaled = 0;
+		enc->frames_scaled = 0;
 	}
 }
 
@@ -199,23 +198,23 @@ static void read_buffers(long number, unsigned char *frame[])
 	int chroma_denominator = 1;
 	unsigned char data[5];
 
-	if(chroma_format == 1) chroma_denominator = 2;
+	if(enc->chroma_format == 1) chroma_denominator = 2;
 
-	pthread_mutex_lock(&input_lock);
+	pthread_mutex_lock(&enc->input_lock);
 
-	if(input_buffer_end) 
+	if(enc->input_buffer_end) 
 	{
-		frames_scaled = 0;
-		pthread_mutex_unlock(&copy_lock);
-		pthread_mutex_unlock(&output_lock);
+		enc->frames_scaled = 0;
+		pthread_mutex_unlock(&enc->copy_lock);
+		pthread_mutex_unlock(&enc->output_lock);
 		return;
 	}
 
-	memcpy(frame[0], input_buffer_y, width * height);
-	memcpy(frame[1], input_buffer_u, width / 2 * height / chroma_denominator);
-	memcpy(frame[2], input_buffer_v, width / 2 * height / chroma_denominator);
-	pthread_mutex_unlock(&copy_lock);
-	pthread_mutex_unlock(&output_lock);
+	memcpy(frame[0], enc->input_buffer_y, enc->width * enc->height);
+	memcpy(frame[1], enc->input_buffer_u, enc->width / 2 * enc->height / chroma_denominator);
+	memcpy(frame[2], enc->input_buffer_v, enc->width / 2 * enc->height / chroma_denominator);
+	pthread_mutex_unlock(&enc->copy_lock);
+	pthread_mutex_unlock(&enc->output_lock);
 }
 
 void readframe(int frame_num, uint8_t *frame[])
@@ -223,12 +222,12 @@ void readframe(int frame_num, uint8_t *frame[])
 	int n;
 	n = frame_num % (2 * READ_LOOK_AHEAD);
 
-	frame[0] = frame_buffers[n][0];
-	frame[1] = frame_buffers[n][1];
-	frame[2] = frame_buffers[n][2];
+	frame[0] = enc->frame_buffers[n][0];
+	frame[1] = enc->frame_buffers[n][1];
+	frame[2] = enc->frame_buffers[n][2];
 	
 
-	switch (inputtype)
+	switch (enc->inputtype)
 	{
 		case T_QUICKTIME:
 			read_quicktime(frame, frame_num);
@@ -111,3 +111,18 @@ void predcomp_11_mmx(char *src,char *dst,int lx, int w, int h, int addflag);
 void predcomp_01_mmx(char *src,char *dst,int lx, int w, int h, int addflag);
 
 #endif
+
+#ifdef __SSE2__
+
+int dist1_00_sse2(uint8_t *blk1, uint8_t *blk2, int lx, int h, int distlim);
+int dist1_01_sse2(uint8_t *blk1, uint8_t *blk2, int lx, int h);
+int dist1_10_sse2(uint8_t *blk1, uint8_t *blk2, int lx, int h);
+int dist1_11_sse2(uint8_t *blk1, uint8_t *blk2, int lx, int h);
+int dist2_sse2(uint8_t *blk1, uint8_t *blk2, int lx, int hx, int hy, int h);
+int bdist1_sse2(uint8_t *pf, uint8_t *pb, uint8_t *p2, int lx,
+				int hxf, int hyf, int hxb, int hyb, int h);
+
+void predcomp_sse2(uint8_t *s, uint8_t *d, int lx, int w, int h,
+				int xh, int yh, int addflag);
+
+#endif
@@ -0,0 +1,256 @@
+/* simd_sse2.c, SSE2 versions of the pixel difference and prediction kernels */
+
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Every routine here gives exactly the same result as the C version in
+ * motion.c or predict.c so the bitstream doesn't depend on the CPU.
+ * psadbw and pavgb only cover the cases where the C rounding matches.
+ * The truncating averages of the dist1 routines subtract the carry
+ * bit from pavgb and the 4 point averages are done in 16 bits.
+ */
+
+#include "config.h"
+#include "global.h"
+#include "simd.h"
+
+#ifdef __SSE2__
+
+#include <emmintrin.h>
+
+#define LOAD16(p) _mm_loadu_si128((__m128i*)(p))
+#define LOAD8(p) _mm_loadl_epi64((__m128i*)(p))
+
+/* (a + b) >> 1 */
+static inline __m128i avg_trunc(__m128i a, __m128i b)
+{
+	__m128i carry = _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1));
+	return _mm_sub_epi8(_mm_avg_epu8(a, b), carry);
+}
+
+/* (a + b + c + d + round) >> 2 for 16 pixels */
+static inline __m128i avg4(__m128i a, __m128i b, __m128i c, __m128i d, __m128i round)
+{
+	__m128i zero = _mm_setzero_si128();
+	__m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(a, zero),
+			_mm_unpacklo_epi8(b, zero)),
+		_mm_add_epi16(_mm_unpacklo_epi8(c, zero),
+			_mm_unpacklo_epi8(d, zero)));
+	__m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(a, zero),
+			_mm_unpackhi_epi8(b, zero)),
+		_mm_add_epi16(_mm_unpackhi_epi8(c, zero),
+			_mm_unpackhi_epi8(d, zero)));
+	lo = _mm_srli_epi16(_mm_add_epi16(lo, round), 2);
+	hi = _mm_srli_epi16(_mm_add_epi16(hi, round), 2);
+	return _mm_packus_epi16(lo, hi);
+}
+
+static inline int sad_total(__m128i sum)
+{
+	return _mm_cvtsi128_si32(sum) +
+		_mm_cvtsi128_si32(_mm_srli_si128(sum, 8));
+}
+
+/* Sum of squared differences of 16 pixels added to 4 ints */
+static inline __m128i ssd_add(__m128i sum, __m128i a, __m128i b)
+{
+	__m128i zero = _mm_setzero_si128();
+	__m128i lo = _mm_sub_epi16(_mm_unpacklo_epi8(a, zero),
+		_mm_unpacklo_epi8(b, zero));
+	__m128i hi = _mm_sub_epi16(_mm_unpackhi_epi8(a, zero),
+		_mm_unpackhi_epi8(b, zero));
+	sum = _mm_add_epi32(sum, _mm_madd_epi16(lo, lo));
+	return _mm_add_epi32(sum, _mm_madd_epi16(hi, hi));
+}
+
+static inline int ssd_total(__m128i sum)
+{
+	sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 8));
+	sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 4));
+	return _mm_cvtsi128_si32(sum);
+}
+
+int dist1_00_sse2(uint8_t *blk1, uint8_t *blk2, int lx, int h, int distlim)
+{
+	int j, s = 0;
+
+	for(j = 0; j < h; j++)
+	{
+		s += sad_total(_mm_sad_epu8(LOAD16(blk1), LOAD16(blk2)));
+		if(s >= distlim) break;
+		blk1 += lx;
+		blk2 += lx;
+	}
+	return s;
+}
+
+int dist1_01_sse2(uint8_t *blk1, uint8_t *blk2, int lx, int h)
+{
+	__m128i sum = _mm_setzero_si128();
+	int j;
+
+	for(j = 0; j < h; j++)
+	{
+		__m128i p = avg_trunc(LOAD16(blk1), LOAD16(blk1 + 1));
+		sum = _mm_add_epi64(sum, _mm_sad_epu8(p, LOAD16(blk2)));
+		blk1 += lx;
+		blk2 += lx;
+	}
+	return sad_total(sum);
+}
+
+int dist1_10_sse2(uint8_t *blk1, uint8_t *blk2, int lx, int h)
+{
+	__m128i sum = _mm_setzero_si128();
+	__m128i row = LOAD16(blk1);
+	int j;
+
+	for(j = 0; j < h; j++)
+	{
+		__m128i next = LOAD16(blk1 + lx);
+		__m128i p = avg_trunc(row, next);
+		sum = _mm_add_epi64(sum, _mm_sad_epu8(p, LOAD16(blk2)));
+		row = next;
+		blk1 += lx;
+		blk2 += lx;
+	}
+	return sad_total(sum);
+}
+
+int dist1_11_sse2(uint8_t *blk1, uint8_t *blk2, int lx, int h)
+{
+	__m128i sum = _mm_setzero_si128();
+	__m128i round = _mm_setzero_si128();
+	__m128i row = LOAD16(blk1);
+	__m128i row1 = LOAD16(blk1 + 1);
+	int j;
+
+	for(j = 0; j < h; j++)
+	{
+		__m128i next = LOAD16(blk1 + lx);
+		__m128i next1 = LOAD16(blk1 + lx + 1);
+		__m128i p = avg4(row, row1, next, next1, round);
+		sum = _mm_add_epi64(sum, _mm_sad_epu8(p, LOAD16(blk2)));
+		row = next;
+		row1 = next1;
+		blk1 += lx;
+		blk2 += lx;
+	}
+	return sad_total(sum);
+}
+
+int dist2_sse2(uint8_t *blk1, uint8_t *blk2, int lx, int hx, int hy, int h)
+{
+	__m128i sum = _mm_setzero_si128();
+	__m128i round = _mm_set1_epi16(2);
+	int j;
+
+	for(j = 0; j < h; j++)
+	{
+		__m128i p;
+		if(!hx && !hy)
+			p = LOAD16(blk1);
+		else
+		if(hx && !hy)
+			p = _mm_avg_epu8(LOAD16(blk1), LOAD16(blk1 + 1));
+		else
+		if(!hx && hy)
+			p = _mm_avg_epu8(LOAD16(blk1), LOAD16(blk1 + lx));
+		else
+			p = avg4(LOAD16(blk1),
+				LOAD16(blk1 + 1),
+				LOAD16(blk1 + lx),
+				LOAD16(blk1 + lx + 1),
+				round);
+		sum = ssd_add(sum, p, LOAD16(blk2));
+		blk1 += lx;
+		blk2 += lx;
+	}
+	return ssd_total(sum);
+}
+
+int bdist1_sse2(uint8_t *pf, uint8_t *pb, uint8_t *p2, int lx,
+	int hxf, int hyf, int hxb, int hyb, int h)
+{
+	__m128i sum = _mm_setzero_si128();
+	__m128i round = _mm_set1_epi16(2);
+	uint8_t *pfa = pf + hxf;
+	uint8_t *pfb = pf + lx * hyf;
+	uint8_t *pfc = pfb + hxf;
+	uint8_t *pba = pb + hxb;
+	uint8_t *pbb = pb + lx * hyb;
+	uint8_t *pbc = pbb + hxb;
+	int j;
+
+	for(j = 0; j < h; j++)
+	{
+		__m128i f = avg4(LOAD16(pf), LOAD16(pfa), LOAD16(pfb), LOAD16(pfc), round);
+		__m128i b = avg4(LOAD16(pb), LOAD16(pba), LOAD16(pbb), LOAD16(pbc), round);
+		sum = _mm_add_epi64(sum, _mm_sad_epu8(_mm_avg_epu8(f, b), LOAD16(p2)));
+		pf += lx;
+		pfa += lx;
+		pfb += lx;
+		pfc += lx;
+		pb += lx;
+		pba += lx;
+		pbb += lx;
+		pbc += lx;
+		p2 += lx;
+	}
+	return sad_total(sum);
+}
+
+/* Same arguments as predcomp_*_mmx but for every half pel case */
+void predcomp_sse2(uint8_t *s, uint8_t *d, int lx, int w, int h,
+	int xh, int yh, int addflag)
+{
+	__m128i round = _mm_set1_epi16(2);
+	int j;
+
+/* Don't read past the block since 8 pixel blocks may end a buffer */
+#define LOADW(p) (w == 16 ? LOAD16(p) : LOAD8(p))
+	for(j = 0; j < h; j++)
+	{
+		__m128i p;
+		if(!xh && !yh)
+			p = LOADW(s);
+		else
+		if(!xh && yh)
+			p = _mm_avg_epu8(LOADW(s), LOADW(s + lx));
+		else
+		if(xh && !yh)
+			p = _mm_avg_epu8(LOADW(s), LOADW(s + 1));
+		else
+			p = avg4(LOADW(s), LOADW(s + 1), LOADW(s + lx), LOADW(s + lx + 1), round);
+
+		if(w == 16)
+		{
+			if(addflag) p = _mm_avg_epu8(p, LOAD16(d));
+			_mm_storeu_si128((__m128i*)d, p);
+		}
+		else
+		{
+			if(addflag) p = _mm_avg_epu8(p, LOAD8(d));
+			_mm_storel_epi64((__m128i*)d, p);
+		}
+		s += lx;
+		d += lx;
+	}
+#undef LOADW
+}
+
+#endif
@@ -80,7 +80,7 @@ void init_transform_hv()
 #ifdef X86_CPU
 	if( (flags & ACCEL_X86_MMX) ) /* MMX CPU */
 	{
-		if(verbose) fprintf( stderr, "SETTING MMX for TRANSFORM!\n");
+		if(enc->verbose) fprintf( stderr, "SETTING MMX for TRANSFORM!\n");
 		pfdct = fdct_mmx;
 		pidct = idct_mmx;
 		padd_pred = add_pred_mmx;
@@ -111,14 +111,14 @@ static void add_pred(unsigned char *pred,
  *     	for (i=0; i<8; i++)
  *     	  cur[i] = clp[blk[i] + pred[i]];
  */
-    	cur[0] = clp[blk[0] + pred[0]];
-    	cur[1] = clp[blk[1] + pred[1]];
-    	cur[2] = clp[blk[2] + pred[2]];
-    	cur[3] = clp[blk[3] + pred[3]];
-    	cur[4] = clp[blk[4] + pred[4]];
-    	cur[5] = clp[blk[5] + pred[5]];
-    	cur[6] = clp[blk[6] + pred[6]];
-    	cur[7] = clp[blk[7] + pred[7]];
+    	cur[0] = enc->clp[blk[0] + pred[0]];
+    	cur[1] = enc->clp[blk[1] + pred[1]];
+    	cur[2] = enc->clp[blk[2] + pred[2]];
+    	cur[3] = enc->clp[blk[3] + pred[3]];
+    	cur[4] = enc->clp[blk[4] + pred[4]];
+    	cur[5] = enc->clp[blk[5] + pred[5]];
+    	cur[6] = enc->clp[blk[6] + pred[6]];
+    	cur[7] = enc->clp[blk[7] + pred[7]];
  
     	blk += 8;
     	cur += lx;
@@ -157,6 +157,7 @@ static void sub_pred(unsigned char *pred,
 
 void transform_engine_loop(transform_engine_t *engine)
 {
+	enc = engine->encoder;
 	while(!engine->done)
 	{
 		pthread_mutex_lock(&(engine->input_lock));
@@ -170,14 +171,28 @@ void transform_engine_loop(transform_engine_t *engine)
 			int16_t (*blocks)[64] = picture->blocks;
 			int i, j, i1, j1, k, n, cc, offs, lx;
 
-			k = (engine->start_row / 16) * (width / 16);
+/* Prediction and DCT type only depend on the macroblocks of these rows */
+			predict_rows(picture, 
+				engine->reff, 
+				engine->refb, 
+				pred, 
+				engine->secondfield, 
+				engine->start_row, 
+				engine->end_row);
+			dct_type_estimation_rows(picture, 
+				pred[0], 
+				cur[0], 
+				engine->start_row, 
+				engine->end_row);
+
+			k = (engine->start_row / 16) * (enc->width / 16);
 
 			for(j = engine->start_row; j < engine->end_row; j += 16)
-    			for(i = 0; i < width; i += 16)
+    			for(i = 0; i < enc->width; i += 16)
     			{
-					mbi[k].dctblocks = &blocks[k * block_count];
+					mbi[k].dctblocks = &blocks[k * enc->block_count];
 
-    				for(n = 0; n < block_count; n++)
+    				for(n = 0; n < enc->block_count; n++)
     				{
 /* color component index */
         				cc = (n < 4) ? 0 : (n & 1) + 1; 
@@ -189,47 +204,47 @@ void transform_engine_loop(transform_engine_t *engine)
 							if ((picture->pict_struct == FRAME_PICTURE) && mbi[k].dct_type)
 							{
 /* field DCT */
-								offs = i + ((n & 1) << 3) + width * (j + ((n & 2) >> 1));
-								lx = width << 1;
+								offs = i + ((n & 1) << 3) + enc->width * (j + ((n & 2) >> 1));
+								lx = enc->width << 1;
 							}
 							else
 							{
 /* frame DCT */
-								offs = i + ((n & 1) << 3) + width2 * (j + ((n & 2) << 2));
-								lx = width2;
+								offs = i + ((n & 1) << 3) + enc->width2 * (j + ((n & 2) << 2));
+								lx = enc->width2;
 							}
 
 							if (picture->pict_struct == BOTTOM_FIELD)
-								offs += width;
+								offs += enc->width;
         				}
         				else
         				{
 /* chrominance */
 /* scale coordinates */
-        					i1 = (chroma_format == CHROMA444) ? i : i >> 1;
-        					j1 = (chroma_format != CHROMA420) ? j : j >> 1;
+        					i1 = (enc->chroma_format == CHROMA444) ? i : i >> 1;
+        					j1 = (enc->chroma_format != CHROMA420) ? j : j >> 1;
 
         					if ((picture->pict_struct==FRAME_PICTURE) && mbi[k].dct_type
-            					&& (chroma_format!=CHROMA420))
+            					&& (enc->chroma_format!=CHROMA420))
         					{
 /* field DCT */
-            					offs = i1 + (n&8) + chrom_width*(j1+((n&2)>>1));
-            					lx = chrom_width<<1;
+            					offs = i1 + (n&8) + enc->chrom_width*(j1+((n&2)>>1));
+            					lx = enc->chrom_width<<1;
         					}
         					else
         					{
 /* frame DCT */
-            					offs = i1 + (n&8) + chrom_width2*(j1+((n&2)<<2));
-            					lx = chrom_width2;
+            					offs = i1 + (n&8) + enc->chrom_width2*(j1+((n&2)<<2));
+            					lx = enc->chrom_width2;
         					}
 
         					if(picture->pict_struct==BOTTOM_FIELD)
-            					offs += chrom_width;
+            					offs += enc->chrom_width;
         				}
 
 						(*psub_pred)(pred[cc]+offs,cur[cc]+offs,lx,
-									 blocks[k*block_count+n]);
-						(*pfdct)(blocks[k*block_count+n]);
+									 blocks[k*enc->block_count+n]);
+						(*pfdct)(blocks[k*enc->block_count+n]);
     				}
 
     				k++;
@@ -239,24 +254,29 @@ void transform_engine_loop(transform_engine_t *engine)
 	}
 }
 
-/* subtract prediction and transform prediction error */
+/* predict, subtract prediction and transform prediction error */
 void transform(pict_data_s *picture,
-	uint8_t *pred[], uint8_t *cur[])
+	uint8_t *reff[], uint8_t *refb[],
+	uint8_t *pred[], uint8_t *cur[],
+	int secondfield)
 {
 	int i;
 /* Start loop */
-	for(i = 0; i < processors; i++)
+	for(i = 0; i < enc->processors; i++)
 	{
-		transform_engines[i].picture = picture;
-		transform_engines[i].pred = pred;
-		transform_engines[i].cur = cur;
-		pthread_mutex_unlock(&(transform_engines[i].input_lock));
+		enc->transform_engines[i].picture = picture;
+		enc->transform_engines[i].pred = pred;
+		enc->transform_engines[i].cur = cur;
+		enc->transform_engines[i].reff = reff;
+		enc->transform_engines[i].refb = refb;
+		enc->transform_engines[i].secondfield = secondfield;
+		pthread_mutex_unlock(&(enc->transform_engines[i].input_lock));
 	}
 
 /* Wait for completion */
-	for(i = 0; i < processors; i++)
+	for(i = 0; i < enc->processors; i++)
 	{
-		pthread_mutex_lock(&(transform_engines[i].output_lock));
+		pthread_mutex_lock(&(enc->transform_engines[i].output_lock));
 	}
 }
 
@@ -265,44 +285,46 @@ void transform(pict_data_s *picture,
 void start_transform_engines()
 {
 	int i;
-	int rows_per_processor = (int)((float)height2 / 16 / processors + 0.5);
+	int rows_per_processor = (int)((float)enc->height2 / 16 / enc->processors + 0.5);
 	int current_row = 0;
 	pthread_attr_t  attr;
 	pthread_mutexattr_t mutex_attr;
 
 	pthread_mutexattr_init(&mutex_attr);
 	pthread_attr_init(&attr);
-	transform_engines = calloc(1, sizeof(transform_engine_t) * processors);
-	for(i = 0; i < processors; i++)
+	enc->transform_engines = calloc(1, sizeof(transform_engine_t) * enc->processors);
+	for(i = 0; i < enc->processors; i++)
 	{
-		transform_engines[i].start_row = current_row * 16;
+		enc->transform_engines[i].start_row = current_row * 16;
 		current_row += rows_per_processor;
-		if(current_row > height2 / 16) current_row = height2 / 16;
-		transform_engines[i].end_row = current_row * 16;
-		pthread_mutex_init(&(transform_engines[i].input_lock), &mutex_attr);
-		pthread_mutex_lock(&(transform_engines[i].input_lock));
-		pthread_mutex_init(&(transform_engines[i].output_lock), &mutex_attr);
-		pthread_mutex_lock(&(transform_engines[i].output_lock));
-		transform_engines[i].done = 0;
-		pthread_create(&(transform_engines[i].tid), 
+		if(current_row > enc->height2 / 16 || 
+			i == enc->processors - 1) current_row = enc->height2 / 16;
+		enc->transform_engines[i].end_row = current_row * 16;
+		pthread_mutex_init(&(enc->transform_engines[i].input_lock), &mutex_attr);
+		pthread_mutex_lock(&(enc->transform_engines[i].input_lock));
+		pthread_mutex_init(&(enc->transform_engines[i].output_lock), &mutex_attr);
+		pthread_mutex_lock(&(enc->transform_engines[i].output_lock));
+		enc->transform_engines[i].done = 0;
+		enc->transform_engines[i].encoder = enc;
+		pthread_create(&(enc->transform_engines[i].tid), 
 			&attr, 
 			(void*)transform_engine_loop, 
-			&transform_engines[i]);
+			&enc->transform_engines[i]);
 	}
 }
 
 void stop_transform_engines()
 {
 	int i;
-	for(i = 0; i < processors; i++)
+	for(i = 0; i < enc->processors; i++)
 	{
-		transform_engines[i].done = 1;
-		pthread_mutex_unlock(&(transform_engines[i].input_lock));
-		pthread_join(transform_engines[i].tid, 0);
-		pthread_mutex_destroy(&(transform_engines[i].input_lock));
-		pthread_mutex_destroy(&(transform_engines[i].output_lock));
+		enc->transform_engines[i].done = 1;
+		pthread_mutex_unlock(&(enc->transform_engines[i].input_lock));
+		pthread_join(enc->transform_engines[i].tid, 0);
+		pthread_mutex_destroy(&(enc->transform_engines[i].input_lock));
+		pthread_mutex_destroy(&(enc->transform_engines[i].output_lock));
 	}
-	free(transform_engines);
+	free(enc->transform_engines);
 }
 
 
@@ -316,6 +338,7 @@ void stop_transform_engines()
 /* inverse transform prediction error and add prediction */
 void itransform_engine_loop(transform_engine_t *engine)
 {
+	enc = engine->encoder;
 	while(!engine->done)
 	{
 		pthread_mutex_lock(&(engine->input_lock));
@@ -331,12 +354,13 @@ void itransform_engine_loop(transform_engine_t *engine)
    for inverse transformation */
 			int16_t (*blocks)[64] = picture->qblocks;
 
-			k = (engine->start_row / 16) * (width / 16);
+			iquantize_rows(picture, engine->start_row, engine->end_row);
+			k = (engine->start_row / 16) * (enc->width / 16);
 
 			for(j = engine->start_row; j < engine->end_row; j += 16)
-				for(i = 0; i < width; i += 16)
+				for(i = 0; i < enc->width; i += 16)
 				{
-					for(n = 0; n < block_count; n++)
+					for(n = 0; n < enc->block_count; n++)
 					{
     				  	cc = (n < 4) ? 0 : (n & 1) + 1; /* color component index */
 
@@ -346,48 +370,48 @@ void itransform_engine_loop(transform_engine_t *engine)
     						if((picture->pict_struct == FRAME_PICTURE) && mbi[k].dct_type)
     						{
 /* field DCT */
-        						offs = i + ((n & 1) << 3) + width * (j + ((n & 2) >> 1));
-        						lx = width<<1;
+        						offs = i + ((n & 1) << 3) + enc->width * (j + ((n & 2) >> 1));
+        						lx = enc->width<<1;
     						}
     						else
     						{
 /* frame DCT */
-        						offs = i + ((n & 1) << 3) + width2 * (j + ((n & 2) << 2));
-        						lx = width2;
+        						offs = i + ((n & 1) << 3) + enc->width2 * (j + ((n & 2) << 2));
+        						lx = enc->width2;
     						}
 
     						if(picture->pict_struct == BOTTOM_FIELD)
-        					offs += width;
+        					offs += enc->width;
     					}
     					else
     					{
 /* chrominance */
 
 /* scale coordinates */
-    						i1 = (chroma_format==CHROMA444) ? i : i>>1;
-    						j1 = (chroma_format!=CHROMA420) ? j : j>>1;
+    						i1 = (enc->chroma_format==CHROMA444) ? i : i>>1;
+    						j1 = (enc->chroma_format!=CHROMA420) ? j : j>>1;
 
     						if((picture->pict_struct == FRAME_PICTURE) && mbi[k].dct_type
-        						&& (chroma_format != CHROMA420))
+        						&& (enc->chroma_format != CHROMA420))
     						{
 /* field DCT */
-        						offs = i1 + (n & 8) + chrom_width * (j1 + ((n & 2) >> 1));
-        						lx = chrom_width << 1;
+        						offs = i1 + (n & 8) + enc->chrom_width * (j1 + ((n & 2) >> 1));
+        						lx = enc->chrom_width << 1;
     						}
     						else
     						{
 /* frame DCT */
-        						offs = i1 + (n&8) + chrom_width2 * (j1 + ((n & 2) << 2));
-        						lx = chrom_width2;
+        						offs = i1 + (n&8) + enc->chrom_width2 * (j1 + ((n & 2) << 2));
+        						lx = enc->chrom_width2;
     						}
 
     						if(picture->pict_struct == BOTTOM_FIELD)
-        						offs += chrom_width;
+        						offs += enc->chrom_width;
     				    }
 
 //pthread_mutex_lock(&test_lock);
-						(*pidct)(blocks[k*block_count+n], engine->temp);
-						(*padd_pred)(pred[cc]+offs,cur[cc]+offs,lx,blocks[k*block_count+n]);
+						(*pidct)(blocks[k*enc->block_count+n], engine->temp);
+						(*padd_pred)(pred[cc]+offs,cur[cc]+offs,lx,blocks[k*enc->block_count+n]);
 //pthread_mutex_unlock(&test_lock);
 					}
 
@@ -403,62 +427,64 @@ void itransform(pict_data_s *picture,
 {
 	int i;
 /* Start loop */
-	for(i = 0; i < processors; i++)
+	for(i = 0; i < enc->processors; i++)
 	{
-		itransform_engines[i].picture = picture;
-		itransform_engines[i].cur = cur;
-		itransform_engines[i].pred = pred;
-		pthread_mutex_unlock(&(itransform_engines[i].input_lock));
+		enc->itransform_engines[i].picture = picture;
+		enc->itransform_engines[i].cur = cur;
+		enc->itransform_engines[i].pred = pred;
+		pthread_mutex_unlock(&(enc->itransform_engines[i].input_lock));
 	}
 
 /* Wait for completion */
-	for(i = 0; i < processors; i++)
+	for(i = 0; i < enc->processors; i++)
 	{
-		pthread_mutex_lock(&(itransform_engines[i].output_lock));
+		pthread_mutex_lock(&(enc->itransform_engines[i].output_lock));
 	}
 }
 
 void start_itransform_engines()
 {
 	int i;
-	int rows_per_processor = (int)((float)height2 / 16 / processors + 0.5);
+	int rows_per_processor = (int)((float)enc->height2 / 16 / enc->processors + 0.5);
 	int current_row = 0;
 	pthread_attr_t  attr;
 	pthread_mutexattr_t mutex_attr;
 
 	pthread_mutexattr_init(&mutex_attr);
 	pthread_attr_init(&attr);
-	itransform_engines = calloc(1, sizeof(transform_engine_t) * processors);
-	for(i = 0; i < processors; i++)
+	enc->itransform_engines = calloc(1, sizeof(transform_engine_t) * enc->processors);
+	for(i = 0; i < enc->processors; i++)
 	{
-		itransform_engines[i].start_row = current_row * 16;
+		enc->itransform_engines[i].start_row = current_row * 16;
 		current_row += rows_per_processor;
-		if(current_row > height2 / 16) current_row = height2 / 16;
-		itransform_engines[i].end_row = current_row * 16;
-		pthread_mutex_init(&(itransform_engines[i].input_lock), &mutex_attr);
-		pthread_mutex_lock(&(itransform_engines[i].input_lock));
-		pthread_mutex_init(&(itransform_engines[i].output_lock), &mutex_attr);
-		pthread_mutex_lock(&(itransform_engines[i].output_lock));
-		itransform_engines[i].done = 0;
-		pthread_create(&(itransform_engines[i].tid), 
+		if(current_row > enc->height2 / 16 || 
+			i == enc->processors - 1) current_row = enc->height2 / 16;
+		enc->itransform_engines[i].end_row = current_row * 16;
+		pthread_mutex_init(&(enc->itransform_engines[i].input_lock), &mutex_attr);
+		pthread_mutex_lock(&(enc->itransform_engines[i].input_lock));
+		pthread_mutex_init(&(enc->itransform_engines[i].output_lock), &mutex_attr);
+		pthread_mutex_lock(&(enc->itransform_engines[i].output_lock));
+		enc->itransform_engines[i].done = 0;
+		enc->itransform_engines[i].encoder = enc;
+		pthread_create(&(enc->itransform_engines[i].tid), 
 			&attr, 
 			(void*)itransform_engine_loop, 
-			&itransform_engines[i]);
+			&enc->itransform_engines[i]);
 	}
 }
 
 void stop_itransform_engines()
 {
 	int i;
-	for(i = 0; i < processors; i++)
+	for(i = 0; i < enc->processors; i++)
 	{
-		itransform_engines[i].done = 1;
-		pthread_mutex_unlock(&(itransform_engines[i].input_lock));
-		pthread_join(itransform_engines[i].tid, 0);
-		pthread_mutex_destroy(&(itransform_engines[i].input_lock));
-		pthread_mutex_destroy(&(itransform_engines[i].output_lock));
+		enc->itransform_engines[i].done = 1;
+		pthread_mutex_unlock(&(enc->itransform_engines[i].input_lock));
+		pthread_join(enc->itransform_engines[i].tid, 0);
+		pthread_mutex_destroy(&(enc->itransform_engines[i].input_lock));
+		pthread_mutex_destroy(&(enc->itransform_engines[i].output_lock));
 	}
-	free(itransform_engines);
+	free(enc->itransform_engines);
 }
 
 
@@ -475,6 +501,15 @@ void dct_type_estimation(
 	uint8_t *pred, uint8_t *cur
 	)
 {
+	dct_type_estimation_rows(picture, pred, cur, 0, enc->height2);
+}
+
+void dct_type_estimation_rows(
+	pict_data_s *picture,
+	uint8_t *pred, uint8_t *cur,
+	int start_row, int end_row
+	)
+{
 
 	struct mbinfo *mbi = picture->mbinfo;
 
@@ -482,10 +517,10 @@ void dct_type_estimation(
 	int i, j, i0, j0, k, offs, s0, s1, sq0, sq1, s01;
 	double d, r;
 
-	k = 0;
+	k = (start_row / 16) * (enc->width / 16);
 
-	for (j0=0; j0<height2; j0+=16)
-		for (i0=0; i0<width; i0+=16)
+	for (j0=start_row; j0<end_row; j0+=16)
+		for (i0=0; i0<enc->width; i0+=16)
 		{
 			if (picture->frame_pred_dct || picture->pict_struct!=FRAME_PICTURE)
 				mbi[k].dct_type = 0;
@@ -498,11 +533,11 @@ void dct_type_estimation(
 				 */
 				for (j=0; j<8; j++)
 				{
-					offs = width*((j<<1)+j0) + i0;
+					offs = enc->width*((j<<1)+j0) + i0;
 					for (i=0; i<16; i++)
 					{
 						blk0[16*j+i] = cur[offs] - pred[offs];
-						blk1[16*j+i] = cur[offs+width] - pred[offs+width];
+						blk1[16*j+i] = cur[offs+enc->width] - pred[offs+enc->width];
 						offs++;
 					}
 				}
@@ -39,16 +39,16 @@ void writeframe(int number, unsigned char *frame[])
   char name[128];
   FILE *fd;
 
-	if(!qt_output) return;
+	if(!enc->qt_output) return;
 //printf("writeframe 1\n");
-  chrom_hsize = (chroma_format==CHROMA444) ? horizontal_size
-                                           : horizontal_size>>1;
+  chrom_hsize = (enc->chroma_format==CHROMA444) ? enc->horizontal_size
+                                           : enc->horizontal_size>>1;
 
-  chrom_vsize = (chroma_format!=CHROMA420) ? vertical_size
-                                           : vertical_size>>1;
+  chrom_vsize = (enc->chroma_format!=CHROMA420) ? enc->vertical_size
+                                           : enc->vertical_size>>1;
 
-	quicktime_set_cmodel(qt_output, BC_YUV420P);
-	quicktime_encode_video(qt_output, 
+	quicktime_set_cmodel(enc->qt_output, BC_YUV420P);
+	quicktime_encode_video(enc->qt_output, 
 		frame, 
 		0);
 }
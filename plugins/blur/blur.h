@@ -23,25 +23,15 @@
 #define BLUR_H
 
 class BlurMain;
-class BlurEngine;
 
 #define MAXRADIUS 100
 
 #include "blurwindow.inc"
 #include "bchash.inc"
-#include "mutex.h"
+#include "gaussianengine.inc"
 #include "pluginvclient.h"
-#include "thread.h"
 #include "vframe.inc"
 
-typedef struct
-{
-	float r;
-    float g;
-    float b;
-    float a;
-} pixel_f;
-
 class BlurConfig
 {
 public:
@@ -80,52 +70,11 @@ public:
 
 	int need_reconfigure;
 
-// a thread for the GUI
-	VFrame *temp, *input, *output;
+	VFrame *input, *output;
 
 private:
-	BlurEngine **engine;
+	GaussianEngine *engine;
 };
 
 
-class BlurEngine : public Thread
-{
-public:
-	BlurEngine(BlurMain *plugin, int start_y, int end_y);
-	~BlurEngine();
-
-	void run();
-	int start_process_frame(VFrame *output, VFrame *input);
-	int wait_process_frame();
-
-// parameters needed for blur
-	int get_constants();
-	void reconfigure();
-	int transfer_pixels(pixel_f *src1, pixel_f *src2, pixel_f *dest, int size);
-	int multiply_alpha(pixel_f *row, int size);
-	int separate_alpha(pixel_f *row, int size);
-	int blur_strip3(int &size);
-	int blur_strip4(int &size);
-
-	int color_model;
-	float vmax;
-	pixel_f *val_p, *val_m, *vp, *vm;
-	pixel_f *sp_p, *sp_m;
-    float n_p[5], n_m[5];
-    float d_p[5], d_m[5];
-    float bd_p[5], bd_m[5];
-    float std_dev;
-	pixel_f *src, *dst;
-    pixel_f initial_p;
-    pixel_f initial_m;
-	int terms;
-	BlurMain *plugin;
-// A margin is introduced between the input and output to give a seemless transition between blurs
-	int start_in, start_out;
-	int end_in, end_out;
-	VFrame *output, *input;
-	int last_frame;
-	Mutex input_lock, output_lock;
-};
-
 #endif
@@ -0,0 +1,103 @@
+
+/*
+ * CINELERRA
+ * Copyright (C) 2008 Adam Williams <broadcast at earthling dot net>
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * 
+ */
+
+#ifndef GAUSSIANENGINE_H
+#define GAUSSIANENGINE_H
+
+#include "gaussianengine.inc"
+#include "loadbalance.h"
+#include "vframe.inc"
+
+// Recursive gaussian blur shared by the blurring plugins.
+// The cost per pixel doesn't depend on the radius.  Rows are filtered in
+// place one at a time.  Columns are filtered in tiles of several adjacent
+// columns, so each row of a tile is read contiguously and the filter runs
+// on all its channels at once.  The frame is never converted to another
+// colormodel.
+
+// Number of columns filtered together
+#define GAUSSIAN_TILE 16
+
+class GaussianPackage : public LoadPackage
+{
+public:
+	GaussianPackage();
+// Rows for the horizontal pass or tiles for the vertical pass
+	int start, end;
+};
+
+class GaussianUnit : public LoadClient
+{
+public:
+	GaussianUnit(GaussianEngine *server);
+	~GaussianUnit();
+
+	void process_package(LoadPackage *package);
+// Filter size samples of lanes channels each from src to dst
+	void filter(float *src, float *dst, int size, int lanes);
+
+	GaussianEngine *server;
+	float *src;
+	float *dst;
+	int allocated;
+};
+
+class GaussianEngine : public LoadServer
+{
+public:
+	GaussianEngine(int total_clients, int total_packages);
+	~GaussianEngine();
+
+// Standard deviation in pixels.  Must be at least 0.5.
+	void set_sigma(double sigma);
+// Blurring radius as used by the Blur plugin, for a 1/255 residue at the
+// edge.
+	static double radius_to_sigma(double radius);
+// Channels to write.  The others are copied from the input.
+	void set_channels(int r, int g, int b, int a);
+// Input and output may be the same frame.
+	void blur(VFrame *output, VFrame *input, int horizontal, int vertical);
+
+	void init_packages();
+	LoadClient* new_client();
+	LoadPackage* new_package();
+
+	enum
+	{
+		HORIZONTAL,
+		VERTICAL
+	};
+
+	VFrame *input;
+	VFrame *output;
+	int pass;
+	int channels[4];
+
+// Causal and anticausal coefficients
+	float n_p[5], n_m[5];
+	float d[5];
+// Response to a constant edge, for extending the edges.
+	float edge_p, edge_m;
+	double sigma;
+};
+
+
+#endif
@@ -0,0 +1,101 @@
+
+/*
+ * CINELERRA
+ * Copyright (C) 2008 Adam Williams <broadcast at earthling dot net>
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * 
+ */
+
+#ifndef REMAPENGINE_H
+#define REMAPENGINE_H
+
+#include "loadbalance.h"
+#include "remapengine.inc"
+#include "vframe.inc"
+
+#include <stdint.h>
+
+// Resampling for effects which move every pixel by a function of its
+// position.  The subclass gives the source coordinates of each output pixel.
+// They are computed once into a fixed point map and reused for every frame
+// until the frame size changes or reset is called, so the plugin only calls
+// reset when its configuration changes.  The input is read with bilinear
+// interpolation.  The input and output must be different frames.
+
+// Fraction bits of the map
+#define REMAP_BITS 8
+#define REMAP_ONE (1 << REMAP_BITS)
+// Map entry for an output pixel with no source
+#define REMAP_OUTSIDE (-0x7fffffff - 1)
+
+class RemapPackage : public LoadPackage
+{
+public:
+	RemapPackage();
+	int row1, row2;
+};
+
+class RemapUnit : public LoadClient
+{
+public:
+	RemapUnit(RemapEngine *server);
+	~RemapUnit();
+
+	void process_package(LoadPackage *package);
+	void build_map(RemapPackage *pkg);
+
+	RemapEngine *server;
+};
+
+class RemapEngine : public LoadServer
+{
+public:
+	RemapEngine(int total_clients, int total_packages);
+	virtual ~RemapEngine();
+
+// Source coordinates of output pixel x, y in the given map.
+// Return 0 if the pixel has no source.  Called from all the clients.
+	virtual int get_source(int x, 
+		int y, 
+		int map, 
+		double &src_x, 
+		double &src_y) = 0;
+
+// Rebuild the map on the next frame
+	void reset();
+// Use 1 map for all channels or 1 map for each of 4 channels.
+	void set_maps(int total);
+// Alpha of pixels without a source, from 0 to 1.  The color is black.
+	void set_outside_alpha(float alpha);
+	void remap(VFrame *output, VFrame *input);
+
+	void init_packages();
+	LoadClient* new_client();
+	LoadPackage* new_package();
+
+	VFrame *input;
+	VFrame *output;
+// x and y of every map for every pixel
+	int32_t *map;
+	int map_w;
+	int map_h;
+	int total_maps;
+	int map_ready;
+	float outside_alpha;
+};
+
+
+#endif
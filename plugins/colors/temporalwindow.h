@@ -0,0 +1,95 @@
+
+/*
+ * CINELERRA
+ * Copyright (C) 2008 Adam Williams <broadcast at earthling dot net>
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * 
+ */
+
+#ifndef TEMPORALWINDOW_H
+#define TEMPORALWINDOW_H
+
+#include "temporalwindow.inc"
+#include "vframe.inc"
+
+#include <stdint.h>
+
+class PluginVClient;
+
+// Window of source frames around the current frame for effects which
+// accumulate several frames.  Frame N is kept in slot N modulo the window
+// size so consecutive windows reuse all the frames they share and only read
+// the frames which entered.  The subclass maintains its accumulation in
+// add_frame and subtract_frame.
+
+class TemporalWindow
+{
+public:
+	TemporalWindow(PluginVClient *plugin);
+	virtual ~TemporalWindow();
+
+// Called for every frame entering or leaving the window.
+// All the leaving frames are subtracted before any frame is added.
+	virtual void add_frame(VFrame *frame) = 0;
+	virtual void subtract_frame(VFrame *frame) = 0;
+
+// Move the window to the size frames starting at first.
+	void update(int64_t first, 
+		int size, 
+		int w, 
+		int h, 
+		int color_model, 
+		double frame_rate);
+// Return 1 if update would subtract any frame.
+	int will_change(int64_t first, int size);
+// Forget all the frames without subtracting them.  Used after the
+// accumulation is cleared.
+	void reset();
+
+// Add sign * (value - offset) to each accumulator.  The offset is chroma
+// for components 1 and 2 of each pixel and 0 for the others.
+	static void accumulate(int *accum, 
+		unsigned char *row, 
+		int total, 
+		int components, 
+		int chroma, 
+		int sign);
+	static void accumulate(int *accum, 
+		uint16_t *row, 
+		int total, 
+		int components, 
+		int chroma, 
+		int sign);
+	static void accumulate(float *accum, 
+		float *row, 
+		int total, 
+		int components, 
+		float chroma, 
+		int sign);
+
+	PluginVClient *plugin;
+	VFrame **frames;
+	int64_t *positions;
+	int *valid;
+	int size;
+
+private:
+	void resize(int64_t first, int size);
+	int get_slot(int64_t position);
+};
+
+
+#endif
@@ -0,0 +1,130 @@
+
+/*
+ * CINELERRA
+ * Copyright (C) 2008 Adam Williams <broadcast at earthling dot net>
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * 
+ */
+
+#ifndef TILEENGINE_H
+#define TILEENGINE_H
+
+#include "bctimer.inc"
+#include "loadbalance.h"
+#include "mainprogress.inc"
+#include "mutex.inc"
+#include "pluginclient.inc"
+#include "tileengine.inc"
+#include "vframe.inc"
+
+// Runs a slow spatial effect on overlapping tiles of the frame in all the
+// CPUs.  Every tile is processed with a border of its neighbours' pixels
+// and the results are crossfaded in the middle of the overlap, so effects
+// which only look a limited distance away show no seams.  The subclass
+// processes 1 tile at a time in process_tile.
+//
+// If a frame takes more than TILE_PROGRESS_DELAY milliseconds during a
+// render a progress bar is shown.  Cancelling it stops the tiles of that
+// frame.  The plugin should return PLUGIN_CANCELLED to stop the render.
+
+#define TILE_PROGRESS_DELAY 1000
+
+class TilePackage : public LoadPackage
+{
+public:
+	TilePackage();
+// Tile to process or rows to blend
+	int tile;
+	int row1, row2;
+};
+
+class TileUnit : public LoadClient
+{
+public:
+	TileUnit(TileEngine *server);
+	~TileUnit();
+
+	void process_package(LoadPackage *package);
+	void process_tile(TilePackage *pkg);
+	void blend(TilePackage *pkg);
+
+	TileEngine *server;
+// Input pixels of the tile
+	VFrame *input;
+// Sum of the weighted tiles for 1 row
+	float *accum;
+	float *weights;
+	int accum_w;
+};
+
+class TileEngine : public LoadServer
+{
+public:
+	TileEngine(PluginClient *plugin, 
+		int total_clients, 
+		int tile_size, 
+		int border);
+	virtual ~TileEngine();
+
+// Process the input into the output, which has the same size and color
+// model.  x and y are the position of the input in the frame.  Called from
+// all the clients.  Slow effects should check is_cancelled.
+	virtual void process_tile(VFrame *output, 
+		VFrame *input, 
+		int x, 
+		int y) = 0;
+// Stop the tiles of the current frame.  The frame keeps its input values.
+	virtual void cancel();
+	int is_cancelled();
+
+// Process the frame in place.  Return 1 if cancelled, leaving the frame
+// unchanged.
+	int process(VFrame *frame);
+
+	void init_packages();
+	LoadClient* new_client();
+	LoadPackage* new_package();
+
+	void tile_done();
+	void get_tile(int tile, int &x1, int &y1, int &x2, int &y2);
+	float get_weight(int position, int start, int end, int size);
+
+	enum
+	{
+		TILES,
+		BLEND
+	};
+
+	PluginClient *plugin;
+	VFrame *frame;
+	int operation;
+	int tile_size;
+	int border;
+	int columns;
+	int rows;
+	int total_tiles;
+// Result of every tile
+	VFrame **tiles;
+	int *tile_ready;
+	int tiles_done;
+	int cancelled;
+	Mutex *progress_lock;
+	MainProgressBar *progress;
+	Timer *timer;
+};
+
+
+#endif
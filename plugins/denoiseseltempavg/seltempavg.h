@@ -27,6 +27,7 @@ class SelTempAvgMain;
 #include "bchash.inc"
 #include "pluginvclient.h"
 #include "seltempavgwindow.h"
+#include "temporalwindow.h"
 #include "vframe.inc"
 
 class SelTempAvgConfig
@@ -68,6 +69,17 @@ public:
 };
 
 
+// Frames being averaged
+class SelTempAvgFrames : public TemporalWindow
+{
+public:
+	SelTempAvgFrames(SelTempAvgMain *client);
+	void add_frame(VFrame *frame);
+	void subtract_frame(VFrame *frame);
+	SelTempAvgMain *client;
+};
+
+
 class SelTempAvgMain : public PluginVClient
 {
 public:
@@ -93,18 +105,12 @@ public:
 
 	char string[64];		
 
-	VFrame **history;
+	SelTempAvgFrames *history;
 
-// Frame of history in requested framerate
-	int64_t *history_frame;
-	int *history_valid;
 	unsigned char *accumulation;
 	unsigned char *accumulation_sq;
 	unsigned char *accumulation_grey;
 
-	int history_size;
-// Starting frame of history in requested framerate
-	int64_t history_start;
 // When subtraction is disabled, this detects no change for paranoid mode.
 	int64_t prev_frame;
 	PLUGIN_CLASS_MEMBERS(SelTempAvgConfig, SelTempAvgThread)
@@ -29,6 +29,7 @@ class GreyCStorationMain;
 #include "greycstorationwindow.h"
 #include "guicast.h"
 #include "pluginvclient.h"
+#include "tileengine.h"
 
 class GreyCStorationConfig
 {
@@ -47,6 +48,19 @@ public:
     float noise_scale ; // alpha
 };
 
+// Regularize overlapping tiles of the frame in all the CPUs
+class GreyCStorationEngine : public TileEngine
+{
+public:
+	GreyCStorationEngine(GreyCStorationMain *client, int cpus);
+	void process_tile(VFrame *output, VFrame *input, int x, int y);
+	void cancel();
+
+	GreyCStorationMain *client;
+// Checked by every iteration of the regularization
+	bool stop_request;
+};
+
 class GreyCStorationMain : public PluginVClient
 {
 public:
@@ -54,7 +68,10 @@ public:
 	~GreyCStorationMain();
 
 	PLUGIN_CLASS_MEMBERS(GreyCStorationConfig, GreyCStorationThread);
-	template<typename T> void GREYCSTORATION(VFrame *frame, int h, int w, int components);
+	template<typename T> void GREYCSTORATION(VFrame *output, 
+		VFrame *input, 
+		int components, 
+		bool *stop_request);
 
 // required for all realtime plugins
 	int process_buffer(VFrame *frame,
@@ -66,6 +83,8 @@ public:
 	void read_data(KeyFrame *keyframe);
 	int load_defaults();
 	int save_defaults();
+
+	GreyCStorationEngine *engine;
 };
 
 
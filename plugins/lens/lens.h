@@ -28,6 +28,7 @@
 #include "loadbalance.h"
 #include "pluginvclient.h"
 #include "pluginwindow.h"
+#include "remapengine.h"
 #include "thread.h"
 
 
@@ -235,38 +236,14 @@ public:
 
 
 
-class LensPackage : public LoadPackage
-{
-public:
-	LensPackage();
-	int row1, row2;
-};
-
-
-class LensUnit : public LoadClient
-{
-public:
-	LensUnit(LensEngine *engine, LensMain *plugin);
-	~LensUnit();
-	void process_package(LoadPackage *package);
-	void process_stretch(LensPackage *pkg);
-	void process_shrink(LensPackage *pkg);
-	void process_rectilinear_stretch(LensPackage *pkg);
-	void process_rectilinear_shrink(LensPackage *pkg);
-	LensEngine *engine;
-	LensMain *plugin;
-};
-
-class LensEngine : public LoadServer
+class LensEngine : public RemapEngine
 {
 public:
 	LensEngine(LensMain *plugin);
 	~LensEngine();
-	
-	void init_packages();
-	LoadClient* new_client();
-	LoadPackage* new_package();
-	
+
+	int get_source(int x, int y, int map, double &src_x, double &src_y);
+
 	LensMain *plugin;
 };
 
@@ -27,11 +27,22 @@
 #include <stdint.h>
 #include <fftw3.h>
 
+#include "arraylist.h"
+#include "loadbalance.h"
 #include "mutex.h"
 
+// Values of PLAN_QUALITY in fourier.rc
+#define FFTW_PLAN_ESTIMATE 0
+#define FFTW_PLAN_MEASURE 1
+#define FFTW_PLAN_PATIENT 2
+
 struct fftw_plan_desc {
 	int samples;
+// Number of windows transformed by each execution
+	int channels;
+// Real samples to samples / 2 + 1 complex bins
 	fftw_plan plan_forward;
+// samples / 2 + 1 complex bins to real samples
 	fftw_plan plan_backward;
 	fftw_plan_desc *next;
 };
@@ -54,14 +65,27 @@ public:
 	virtual int update_progress(int current_position);
 
 	fftw_plan_desc *my_fftw_plan;
-	int ready_fftw(unsigned int samples);
-	void do_fftw_inplace(unsigned int samples,
-		int inverse,
-		fftw_complex *data);
+	int ready_fftw(unsigned int samples, int channels = 1);
+// Complex numbers between channels in a plan for several channels
+	static int bin_stride(unsigned int samples);
+// Arrays must come from fftw_malloc.
+// The forward transform writes samples / 2 + 1 bins.
+	void do_fftw_r2c(unsigned int samples,
+		double *real_in,
+		fftw_complex *data_out);
+// Destroys data_in.  The output isn't normalized.
+	void do_fftw_c2r(unsigned int samples,
+		fftw_complex *data_in,
+		double *real_out);
 
 // We have to get around the thread unsafety of fftw
 	static fftw_plan_desc *fftw_plans;
 	static Mutex plans_lock;
+// Planning flags from fourier.rc and whether the wisdom file was read.
+	static int plan_flags;
+	static int wisdom_loaded;
+	static void load_wisdom();
+	static void save_wisdom();
 
 
 };
@@ -70,6 +94,9 @@ public:
 class CrossfadeFFT : public FFT
 {
 public:
+	friend class MultichannelFFT;
+	friend class MultichannelFFTUnit;
+
 	CrossfadeFFT();
 	virtual ~CrossfadeFFT();
 
@@ -81,6 +108,17 @@ public:
 	int delete_fft();
 	// functioy to be called to initialize oversampling
 	void set_oversample(int oversample); // 2, 4,8 are good values
+	static int fix_oversample(int oversample);
+	static void make_windows(int window_size, 
+		int oversample, 
+		double *pre_window, 
+		double *post_window);
+// Use windows and FFTW buffers owned by a MultichannelFFT instead of set_oversample
+	void share_buffers(int oversample,
+		double *pre_window,
+		double *post_window,
+		double *fftw_samples,
+		fftw_complex *fftw_data);
 	
 
 
@@ -121,18 +159,26 @@ public:
 // Output of FFT
 	double *freq_real;
 	double *freq_imag;
-// data for FFT that is going to be done by FFTW
+// Bins 0 to window_size / 2 of the window transformed by FFTW
 	fftw_complex *fftw_data;
 
 private:
+// Steps of process_buffer_oversample
+	void start_buffer_oversample(int64_t output_sample, 
+		long size, 
+		int direction);
+// Returns 1 if the input couldn't be read
+	int read_window_oversample();
+	void overlap_window_oversample();
+	void finish_buffer_oversample(long size, double *output_ptr);
 
 // input for complete windows
 	double *input_buffer;
 // output for crossfaded windows with overflow
 	double *output_buffer;
 
-	double *temp_real;
-	double *temp_imag;
+// Real samples going into and coming out of FFTW
+	double *fftw_samples;
 
 // samples in input_buffer
 	long input_size;
@@ -156,10 +202,76 @@ private:
 	double *pre_window;
 // Triangle window precalculated
 	double *post_window;
+// Windows and FFTW buffers belong to a MultichannelFFT
+	int shared_buffers;
+// State of the current process_buffer_oversample
+	int step;
+	int total_size;
+	int start_skip;
 protected:
 // Oversample factor
 	int oversample;
 
 };
 
+
+class MultichannelFFT;
+
+class MultichannelFFTPackage : public LoadPackage
+{
+public:
+	MultichannelFFTPackage();
+	int channel;
+};
+
+class MultichannelFFTUnit : public LoadClient
+{
+public:
+	MultichannelFFTUnit(MultichannelFFT *fft, LoadServer *server);
+	void process_package(LoadPackage *package);
+	MultichannelFFT *fft;
+};
+
+class MultichannelFFTServer : public LoadServer
+{
+public:
+	MultichannelFFTServer(MultichannelFFT *fft, int cpus, int channels);
+	void init_packages();
+	LoadClient* new_client();
+	LoadPackage* new_package();
+	MultichannelFFT *fft;
+};
+
+// Runs the windows of several CrossfadeFFT channels together.  The channels
+// share the windows and their FFTW buffers are consecutive so all of them are
+// transformed by one plan.  With more than 1 cpu the channels are transformed
+// and processed in parallel instead.
+class MultichannelFFT : public FFT
+{
+public:
+	MultichannelFFT(int cpus);
+	~MultichannelFFT();
+
+// Takes ownership of the channel.  Add all channels before initialize.
+	void append(CrossfadeFFT *channel);
+	int initialize(int window_size, int oversample);
+// output_ptr - one buffer for each channel
+	int process_buffer_oversample(int64_t output_sample,
+		long size, 
+		double **output_ptr,
+		int direction);
+
+	ArrayList<CrossfadeFFT*> channels;
+// Result of reading each channel's window
+	int *results;
+	int cpus;
+	int window_size;
+	int oversample;
+	double *pre_window;
+	double *post_window;
+	double *fftw_samples;
+	fftw_complex *fftw_data;
+	MultichannelFFTServer *server;
+};
+
 #endif
@@ -28,6 +28,7 @@
 
 #include "affine.inc"
 #include "bchash.inc"
+#include "edit.inc"
 #include "filexml.inc"
 #include "keyframe.inc"
 #include "loadbalance.h"
@@ -38,8 +39,10 @@
 #include "vframe.inc"
 
 class MotionMain;
+class MotionPyramid;
 class MotionWindow;
 class MotionScan;
+class MotionTracks;
 class RotateScan;
 
 
@@ -65,6 +68,15 @@ class RotateScan;
 // Precision of rotation
 #define MIN_ANGLE 0.0001
 
+// Number of times the frames are halved for the pyramid search
+#define MAX_PYRAMID 4
+// Smallest block in pixels searched in a reduced frame
+#define PYRAMID_MIN_BLOCK 16
+
+// Hash table sizes of the scan caches.  Must be powers of 2.
+#define MOTION_CACHE_BUCKETS 4096
+#define ROTATE_CACHE_BUCKETS 1024
+
 #define MOTION_FILE "/tmp/motion"
 #define ROTATION_FILE "/tmp/rotate"
 
@@ -106,6 +118,8 @@ public:
 	int global;
 	int rotate;
 	int addtrackedframeoffset;
+// Search reduced copies of the frames before the full size frames
+	int pyramid;
 // Track or stabilize, single pixel, scan only, or nothing
 	int mode1;
 // Recalculate, no calculate, save, or load coordinates from disk
@@ -161,6 +175,11 @@ public:
 // Calculate frame to copy from and frame to move
 	void calculate_pointers(VFrame **frame, VFrame **src, VFrame **dst);
 	void allocate_temp(int w, int h, int color_model);
+	void get_tracks_path(char *path);
+// Edit under a position of the plugin
+	Edit* get_edit(int64_t position);
+// Frame of the source asset shown at a position of the plugin or -1
+	int64_t get_asset_frame(int64_t position);
 
 	PLUGIN_CLASS_MEMBERS(MotionConfig, MotionThread)
 
@@ -203,6 +222,17 @@ public:
 	RotateScan *motion_rotate;
 	OverlayFrame *overlayer;
 	AffineEngine *rotate_engine;
+// Vectors saved by an earlier pass
+	MotionTracks *tracks;
+// Frames in the source asset of the current frame and the single tracked
+// frame.  The tracks are stored by these so editing doesn't shift them.
+	int64_t asset_frame;
+	int64_t track_asset_frame;
+// The vectors for the current frame come from tracks instead of a scan.
+	int lookup_vectors;
+// The reference frames weren't read for a lookup and must be reloaded
+// before the next scan.
+	int stale_reference;
 
 // Accumulation of all global tracks since the plugin start.
 // Multiplied by OVERSAMPLE.
@@ -307,6 +337,24 @@ public:
 	MotionScanCache(int x, int y, int64_t difference);
 	int x, y;
 	int64_t difference;
+// Next entry in the same hash bucket
+	MotionScanCache *next;
+};
+
+// A frame and copies of it halved in size for each level of a pyramid search
+class MotionPyramid
+{
+public:
+	MotionPyramid();
+	~MotionPyramid();
+
+// Level 0 is the frame itself.  Recalculates all the other levels.
+	void update(VFrame *frame, int levels);
+	VFrame* get_level(int level);
+	static void downsample(VFrame *dst, VFrame *src);
+
+	VFrame *levels[MAX_PYRAMID + 1];
+	int total_levels;
 };
 
 class MotionScanUnit : public LoadClient
@@ -347,6 +395,7 @@ public:
 		VFrame *current_frame);
 	int64_t get_cache(int x, int y);
 	void put_cache(int x, int y, int64_t difference);
+	void reset_cache();
 
 // Change between previous frame and current frame multiplied by 
 // OVERSAMPLE
@@ -371,9 +420,21 @@ private:
 	int total_pixels;
 	int total_steps;
 	int subpixel;
+// Cache is only valid for the full size frames
+	int use_cache;
 
+// Start the search with reduced frames.  Returns the position in the full 
+// size previous frame to refine and the size of the remaining scan.
+	void scan_pyramid(int &x_result, 
+		int &y_result, 
+		int &scan_w, 
+		int &scan_h);
+
+	MotionPyramid *previous_pyramid;
+	MotionPyramid *current_pyramid;
 
 	ArrayList<MotionScanCache*> cache;
+	MotionScanCache *cache_table[MOTION_CACHE_BUCKETS];
 	Mutex *cache_lock;
 };
 
@@ -403,6 +464,8 @@ public:
 	RotateScanCache(float angle, int64_t difference);
 	float angle;
 	int64_t difference;
+// Next entry in the same hash bucket
+	RotateScanCache *next;
 };
 
 class RotateScanUnit : public LoadClient
@@ -443,6 +506,7 @@ public:
 		int block_y);
 	int64_t get_cache(float angle);
 	void put_cache(float angle, int64_t difference);
+	void reset_cache();
 
 
 // Angle result
@@ -473,7 +537,18 @@ private:
 	float scan_angle1, scan_angle2;
 	int total_steps;
 
+// Compare level of the pyramid instead of the full size frames
+	void set_level(int level);
+	VFrame *full_previous_frame;
+	VFrame *full_current_frame;
+	int full_block_x, full_block_y;
+	int full_block_x1, full_block_y1, full_block_x2, full_block_y2;
+	int full_scan_x, full_scan_y, full_scan_w, full_scan_h;
+	MotionPyramid *previous_pyramid;
+	MotionPyramid *current_pyramid;
+
 	ArrayList<RotateScanCache*> cache;
+	RotateScanCache *cache_table[ROTATE_CACHE_BUCKETS];
 	Mutex *cache_lock;
 };
 
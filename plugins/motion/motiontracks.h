@@ -0,0 +1,65 @@
+
+/*
+ * CINELERRA
+ * Copyright (C) 2008 Adam Williams <broadcast at earthling dot net>
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ * 
+ */
+
+#ifndef MOTIONTRACKS_H
+#define MOTIONTRACKS_H
+
+#include "bcwindowbase.inc"
+
+#include <stdint.h>
+
+// Binary file of the motion vectors computed for each frame of a source
+// asset.
+// Records have a fixed size and are stored at the offset of their frame
+// number, so a lookup or an update is a single read or write.  Frames
+// which were never written read back as holes.
+
+class MotionTracks
+{
+public:
+	MotionTracks();
+	~MotionTracks();
+
+	enum
+	{
+		TRANSLATION = 1,
+		ROTATION = 2
+	};
+
+// Use a different file.  An empty path disables the tracks.
+	void set_path(const char *path);
+// Return 1 if the requested parts of the record for the frame don't exist.
+	int get(int64_t frame, int parts, int *dx, int *dy, float *angle);
+	int has(int64_t frame, int parts);
+	void put_translation(int64_t frame, int dx, int dy);
+	void put_rotation(int64_t frame, float angle);
+
+private:
+	int open_file();
+	int read_record(int64_t frame, unsigned char *record);
+	void write_record(int64_t frame, unsigned char *record);
+
+	int fd;
+	char path[BCTEXTLEN];
+};
+
+
+#endif
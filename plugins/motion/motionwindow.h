@@ -276,6 +276,18 @@ public:
 	MotionMain *plugin;
 };
 
+class MotionPyramidSearch : public BC_CheckBox
+{
+public:
+	MotionPyramidSearch(MotionMain *plugin, 
+		MotionWindow *gui,
+		int x, 
+		int y);
+	int handle_event();
+	MotionWindow *gui;
+	MotionMain *plugin;
+};
+
 class MotionGlobal : public BC_CheckBox
 {
 public:
@@ -329,6 +341,7 @@ public:
 	MotionReturnSpeed *return_speed;
 	Mode1 *mode1;
 	MotionDrawVectors *vectors;
+	MotionPyramidSearch *pyramid;
 	MotionGlobal *global;
 	MotionRotate *rotate;
 	AddTrackedFrameOffset *addtrackedframeoffset;
@@ -77,13 +77,14 @@ public:
 class PitchFFT : public CrossfadeFFT
 {
 public:
-	PitchFFT(PitchEffect *plugin);
+	PitchFFT(PitchEffect *plugin, int channel);
 	~PitchFFT();
 	int signal_process_oversample(int reset);
 	int read_samples(int64_t output_sample, 
 		int samples, 
 		double *buffer);
 	PitchEffect *plugin;
+	int channel;
 	
 	double *last_phase;
 	double *new_freq;
@@ -100,10 +101,11 @@ public:
 	~PitchEffect();
 
 	int is_realtime();
+	int is_multichannel();
 	void read_data(KeyFrame *keyframe);
 	void save_data(KeyFrame *keyframe);
 	int process_buffer(int64_t size, 
-		double *buffer,
+		double **buffer,
 		int64_t start_position,
 		int sample_rate);
 	int load_defaults();
@@ -111,7 +113,7 @@ public:
 	void reset();
 	void update_gui();
 
-	PitchFFT *fft;
+	MultichannelFFT *fft;
 	PLUGIN_CLASS_MEMBERS(PitchConfig, PitchThread)
 };
 
@@ -27,6 +27,7 @@
 class SvgMain;
 class SvgThread;
 
+#include "arraylist.h"
 #include "bchash.h"
 #include "mutex.h"
 #include "svgwin.h"
@@ -34,6 +35,14 @@ class SvgThread;
 #include "pluginvclient.h"
 #include "thread.h"
 
+// Rasters are rendered at this resolution
+#define SVG_DPI 90
+// Names of the rasters in the index directory
+#define SVG_PREFIX "svg_"
+#define SVG_SUFFIX ".raw"
+// Rasters in the index directory are pruned down to this size
+#define SVG_CACHE_BYTES 0x10000000
+
 class SvgConfig
 {
 public:
@@ -67,10 +76,30 @@ public:
 	void read_data(KeyFrame *keyframe);
 	int load_defaults();
 	int save_defaults();
+	void find_links();
+	int hash_svg();
+	void get_raster_directory(char *directory);
+	void get_raster_path(char *path);
+	void prune_rasters();
+	int rasterize(char *path);
+	int load_raster(char *path, int color_model);
 	OverlayFrame *overlayer;   // To translate images
 	VFrame *temp_frame;        // Used if buffers are the same
 	int need_reconfigure;
 	int force_raw_render;     //force rendering of PNG on first start
+// Contents of the SVG file and the stat they were read with
+	char *svg_data;
+	int svg_data_size;
+	uint64_t svg_data_hash;
+// Local files linked from the drawing
+	ArrayList<char*> svg_links;
+// Hash of the drawing and the state of the linked files
+	uint64_t svg_hash;
+	char svg_path[BCTEXTLEN];
+	int64_t svg_mtime;
+	int64_t svg_size;
+// Cached raster in temp_frame
+	char raster_path[BCTEXTLEN];
 	PLUGIN_CLASS_MEMBERS(SvgConfig, SvgThread)
 };
 
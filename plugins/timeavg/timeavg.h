@@ -26,6 +26,7 @@ class TimeAvgMain;
 
 #include "bchash.inc"
 #include "pluginvclient.h"
+#include "temporalwindow.h"
 #include "timeavgwindow.h"
 #include "vframe.inc"
 
@@ -49,6 +50,17 @@ public:
 };
 
 
+// Frames being averaged
+class TimeAvgFrames : public TemporalWindow
+{
+public:
+	TimeAvgFrames(TimeAvgMain *client);
+	void add_frame(VFrame *frame);
+	void subtract_frame(VFrame *frame);
+	TimeAvgMain *client;
+};
+
+
 class TimeAvgMain : public PluginVClient
 {
 public:
@@ -71,14 +83,8 @@ public:
 	void transfer_accum(VFrame *frame);
 
 
-	VFrame **history;
-// Frame of history in requested samplerate
-	int64_t *history_frame;
-	int *history_valid;
+	TimeAvgFrames *history;
 	unsigned char *accumulation;
-	int history_size;
-// Starting frame of history in requested framerate
-	int64_t history_start;
 // When subtraction is disabled, this detects no change for paranoid mode.
 	int64_t prev_frame;
 	PLUGIN_CLASS_MEMBERS(TimeAvgConfig, TimeAvgThread)
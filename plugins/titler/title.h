@@ -29,10 +29,13 @@
 
 // Stage 1:
 // Only performed when text mask changes.
-// Update glyph cache with every glyph used in the title.
+// Update glyph cache with every glyph used in the title.  The glyph cache
+// is shared by all the titles in the process.
 // A parallel text renderer draws one character per CPU.
 // The titler direct copies all the text currently visible onto the text mask.
 // in integer coordinates.
+// When the visible rows scroll, rows already on the text mask are copied
+// and only the new rows are drawn.
 // The text mask is in the same color space as the output but always has
 // an alpha channel.
 
@@ -92,6 +95,7 @@ public:
 
 // Only used to clear glyphs
 	int equivalent(TitleConfig &that);
+	int equivalent_layout(TitleConfig &that);
 	void copy_from(TitleConfig &that);
 	void interpolate(TitleConfig &prev, 
 		TitleConfig &next, 
@@ -150,6 +154,42 @@ public:
 	int width, height, pitch, advance_w, left, top, freetype_index;
 	VFrame *data;
 	VFrame *data_stroke;
+
+// Font path, size and stroke width the glyph was rendered with.
+// Stroke width is -1 if no outline.
+	char *path;
+	int size;
+	double stroke_width;
+// Number of titles using the glyph
+	int users;
+	TitleGlyph *next;
+};
+
+
+#define TITLE_GLYPH_BUCKETS 1024
+// Unused glyphs are deleted when the cache exceeds this many bytes
+#define TITLE_GLYPH_BYTES 0x4000000
+
+// Glyphs for all the titles in the process
+class TitleGlyphCache
+{
+public:
+	TitleGlyphCache();
+	~TitleGlyphCache();
+
+// Must be called with the lock held.
+// Returns the glyph with a user added.  A glyph not in the cache is created
+// without data and must be rendered before the lock is released.
+	TitleGlyph* get(const char *path, 
+		int size, 
+		double stroke_width, 
+		FT_ULong char_code);
+	void release(TitleGlyph *glyph);
+// Delete unused glyphs if the cache is too big
+	void prune();
+
+	Mutex *lock;
+	TitleGlyph *buckets[TITLE_GLYPH_BUCKETS];
 };
 
 
@@ -179,6 +219,8 @@ public:
 	BC_FontEntry *current_font;       // Current font configured by freetype
 	FT_Library freetype_library;      	// Freetype library
 	FT_Face freetype_face;
+// Path of the loaded face
+	char current_path[BCTEXTLEN];
 };
 
 class GlyphEngine : public LoadServer
@@ -203,7 +245,7 @@ class TitlePackage : public LoadPackage
 public:
 	TitlePackage();
 	int x, y;
-	wchar_t char_code;
+	TitleGlyph *glyph;
 };
 
 
@@ -212,7 +254,11 @@ class TitleUnit : public LoadClient
 public:
 	TitleUnit(TitleMain *plugin, TitleEngine *server);
 	void process_package(LoadPackage *package);
-	void draw_glyph(VFrame *output, TitleGlyph *glyph, int x, int y);
+	void draw_glyph(VFrame *output, 
+		VFrame *data, 
+		TitleGlyph *glyph, 
+		int x, 
+		int y);
 	TitleMain *plugin;
 };
 
@@ -329,9 +375,11 @@ public:
 	int save_defaults();
 	void draw_glyphs();
 	int draw_mask();
+// Copy the rows between copy_row1 and copy_row2 from the previous mask
+	void scroll_mask(VFrame *dst, VFrame *src);
 	void overlay_mask();
 	BC_FontEntry* get_font();
-	int get_char_advance(FT_ULong current, FT_ULong next);
+	int get_char_advance(int number);
 	int get_char_height();
 	void get_total_extents();
 	void clear_glyphs();
@@ -342,8 +390,12 @@ public:
 	static char* motion_to_text(int motion);
 	static int text_to_motion(char *text);
 	PLUGIN_CLASS_MEMBERS(TitleConfig, TitleThread)
-	ArrayList<TitleGlyph*> glyphs;
-	Mutex glyph_lock;
+// Glyph of every character in the text
+	TitleGlyph **char_glyphs;
+	int total_char_glyphs;
+// Glyphs not in the cache yet
+	ArrayList<TitleGlyph*> new_glyphs;
+	static TitleGlyphCache glyph_cache;
 
 // Stage 1 parameters must be compared to redraw the text mask
 	VFrame *text_mask;
@@ -355,6 +407,7 @@ public:
 // Necessary to get character width
 	FT_Library freetype_library;      	// Freetype library
 	FT_Face freetype_face;
+	char face_path[BCTEXTLEN];
 
 // Visible area of all text present in the mask.
 // Horizontal characters aren't clipped because column positions are
@@ -363,6 +416,12 @@ public:
 	int visible_row2;
 	int visible_char1;
 	int visible_char2;
+// Rows drawn on the text mask
+	int mask_row1;
+	int mask_row2;
+// Rows copied from the previous text mask instead of drawn
+	int copy_row1;
+	int copy_row2;
 // relative position of all text to output
 	float text_y1;
 	float text_y2;
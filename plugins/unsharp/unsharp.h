@@ -28,6 +28,7 @@
 
 #include "bchash.inc"
 #include "filexml.inc"
+#include "gaussianengine.inc"
 #include "keyframe.inc"
 #include "loadbalance.h"
 #include "pluginvclient.h"
@@ -76,6 +77,9 @@ public:
 	PLUGIN_CLASS_MEMBERS(UnsharpConfig, UnsharpThread)
 
 	UnsharpEngine *engine;
+	GaussianEngine *blur_engine;
+// Blurred copy of the frame
+	VFrame *blurry;
 };
 
 
@@ -96,7 +100,6 @@ public:
 
 	UnsharpEngine *server;
 	UnsharpMain *plugin;
-	VFrame *temp;
 };
 
 class UnsharpEngine : public LoadServer
@@ -362,6 +362,10 @@ int quicktime_write_vbr_frame(quicktime_t *file,
 void quicktime_update_stco(quicktime_stco_t *stco, long chunk, int64_t offset);
 void quicktime_update_stsz(quicktime_stsz_t *stsz, long sample, long sample_size);
 int quicktime_update_stsc(quicktime_stsc_t *stsc, long chunk, long samples);
+int64_t* quicktime_stsc_totals(quicktime_stsc_t *stsc);
+void quicktime_stsc_reset_totals(quicktime_stsc_t *stsc);
+int64_t* quicktime_stsz_totals(quicktime_stsz_t *stsz);
+void quicktime_stsz_reset_totals(quicktime_stsz_t *stsz);
 int quicktime_trak_duration(quicktime_trak_t *trak, long *duration, long *timescale);
 int quicktime_trak_fix_counts(quicktime_t *file, quicktime_trak_t *trak);
 int quicktime_sample_size(quicktime_trak_t *trak, int sample);
@@ -131,6 +131,8 @@ static int read_cmov(quicktime_t *file,
 			file->old_preload_start = file->preload_start;
 			file->old_preload_end = file->preload_end;
 			file->old_preload_ptr = file->preload_ptr;
+			file->old_total_preload_windows = file->total_preload_windows;
+			file->total_preload_windows = 0;
 			file->preload_size = uncompressed_size;
 			file->preload_buffer = data_out;
 			file->preload_start = moov_atom->start;
@@ -150,6 +152,7 @@ static int read_cmov(quicktime_t *file,
 			file->preload_start = file->old_preload_start;
 			file->preload_end = file->old_preload_end;
 			file->preload_ptr = file->old_preload_ptr;
+			file->total_preload_windows = file->old_total_preload_windows;
 			quicktime_set_position(file, moov_atom->end);
 		}
 		else
@@ -267,6 +267,9 @@ typedef struct
 	
 	long entries_allocated;
 	quicktime_stsc_table_t *table;
+/* Samples before the first chunk of each entry.  Built on the first seek. */
+	int64_t *sample_totals;
+	long totals_entries;
 } quicktime_stsc_t;
 
 
@@ -285,6 +288,9 @@ typedef struct
 
 	long entries_allocated;    /* used by the library for allocating a table */
 	quicktime_stsz_table_t *table;
+/* Bytes before each sample.  Built on the first seek. */
+	int64_t *size_totals;
+	long totals_entries;
 } quicktime_stsz_t;
 
 
@@ -637,13 +643,31 @@ typedef struct
 	int u_size;
 	int v_size;
 	int64_t frame_number;
+/* Next frame in the same hash bucket or -1 */
+	int next;
 } quicktime_cacheframe_t;
 
+/* Bytes of frames kept before the oldest frames are replaced */
+#define QUICKTIME_CACHE_BYTES 0x20000000
+
 typedef struct
 {
+/* Ring of frames in the order they were put.  The buffers of replaced */
+/* frames are reused by the new frames, except the last frame returned. */
 	quicktime_cacheframe_t *frames;
 	int total;
 	int allocation;
+/* Oldest frame in the ring */
+	int first;
+/* First frame in each hash bucket or -1 */
+	int *buckets;
+/* Bytes in the frames of the ring */
+	int64_t bytes;
+	int64_t max_bytes;
+/* Buffers of the last frame returned by get_frame.  lent_owned is set */
+/* once its slot is reused and the cache has to free them. */
+	unsigned char *lent_y, *lent_u, *lent_v;
+	int lent_owned;
 } quicktime_cache_t;
 
 /* table of pointers to every track */
@@ -669,6 +693,21 @@ typedef struct
 	void *codec;
 } quicktime_video_map_t;
 
+/* Read ahead buffer which isn't in use.  Swapped with the preload_ fields */
+/* when a read is in its part of the file. */
+typedef struct
+{
+	char *buffer;
+	int64_t start;
+	int64_t end;
+	int64_t ptr;
+/* Time it was swapped out for replacing the oldest buffer */
+	int64_t age;
+} quicktime_preload_t;
+
+/* Total read ahead buffers including the one in the preload_ fields */
+#define QUICKTIME_PRELOAD_WINDOWS 4
+
 /* file descriptor passed to all routines */
 typedef struct
 {
@@ -693,6 +732,7 @@ typedef struct
 	int64_t old_preload_start;
 	int64_t old_preload_end;
 	int64_t old_preload_ptr;
+	int old_total_preload_windows;
 
 
 /* ASF section */
@@ -731,6 +771,10 @@ typedef struct
 	int64_t preload_start;     /* Start of preload_buffer in file */
 	int64_t preload_end;       /* End of preload buffer in file */
 	int64_t preload_ptr;       /* Offset of preload_start in preload_buffer */
+/* Buffers for the other parts of the file being read */
+	quicktime_preload_t preload_windows[QUICKTIME_PRELOAD_WINDOWS - 1];
+	int total_preload_windows;
+	int64_t preload_age;
 
 /* Write ahead buffer */
 /* Amount of data in presave buffer */
@@ -329,11 +329,7 @@ int quicktime_delete(quicktime_t *file)
 	if(file->moov_data)
 		free(file->moov_data);
 
-	if(file->preload_size)
-	{
-		free(file->preload_buffer);
-		file->preload_size = 0;
-	}
+	quicktime_set_preload(file, 0);
 
 	if(file->presave_buffer)
 	{
@@ -360,6 +356,7 @@ int quicktime_set_cpus(quicktime_t *file, int cpus)
 
 void quicktime_set_preload(quicktime_t *file, int64_t preload)
 {
+	int i;
 	file->preload_size = preload;
 	if(file->preload_buffer) free(file->preload_buffer);
 	file->preload_buffer = 0;
@@ -368,6 +365,20 @@ void quicktime_set_preload(quicktime_t *file, int64_t preload)
 	file->preload_start = 0;
 	file->preload_end = 0;
 	file->preload_ptr = 0;
+
+/* The other buffers are allocated when they're first used */
+	for(i = 0; i < QUICKTIME_PRELOAD_WINDOWS - 1; i++)
+	{
+		quicktime_preload_t *window = &file->preload_windows[i];
+		if(window->buffer) free(window->buffer);
+		window->buffer = 0;
+		window->start = 0;
+		window->end = 0;
+		window->ptr = 0;
+		window->age = 0;
+	}
+	file->total_preload_windows = preload ? QUICKTIME_PRELOAD_WINDOWS - 1 : 0;
+	file->preload_age = 0;
 }
 
 
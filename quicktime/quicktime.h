@@ -416,8 +416,8 @@ int quicktime_set_cpus(quicktime_t *file, int cpus);
 
 /* Specify whether to read contiguously or not. */
 /* preload is the number of bytes to read ahead. */
-/* This is no longer functional to the end user but is used to accelerate */
-/* reading the header internally. */
+/* QUICKTIME_PRELOAD_WINDOWS buffers of this size are kept for reads in */
+/* different parts of the file.  Only use it for files opened for reading. */
 void quicktime_set_preload(quicktime_t *file, int64_t preload);
 
 int64_t quicktime_byte_position(quicktime_t *file);
@@ -9,6 +9,8 @@ void quicktime_stsc_init(quicktime_stsc_t *stsc)
 	stsc->flags = 0;
 	stsc->total_entries = 0;
 	stsc->entries_allocated = 0;
+	stsc->sample_totals = 0;
+	stsc->totals_entries = 0;
 }
 
 void quicktime_stsc_init_table(quicktime_t *file, quicktime_stsc_t *stsc)
@@ -46,6 +48,7 @@ void quicktime_stsc_delete(quicktime_stsc_t *stsc)
 {
 	if(stsc->total_entries) free(stsc->table);
 	stsc->total_entries = 0;
+	quicktime_stsc_reset_totals(stsc);
 }
 
 void quicktime_stsc_dump(quicktime_stsc_t *stsc)
@@ -101,6 +104,7 @@ void quicktime_write_stsc(quicktime_t *file, quicktime_stsc_t *stsc)
 	}
 	last_same++;
 	stsc->total_entries = last_same;
+	quicktime_stsc_reset_totals(stsc);
 
 
 	quicktime_write_char(file, stsc->version);
@@ -131,9 +135,40 @@ int quicktime_update_stsc(quicktime_stsc_t *stsc, long chunk, long samples)
 	stsc->table[chunk - 1].chunk = chunk;
 	stsc->table[chunk - 1].id = 1;
 	if(chunk > stsc->total_entries) stsc->total_entries = chunk;
+	quicktime_stsc_reset_totals(stsc);
 	return 0;
 }
 
+// Sample number of the first chunk of every entry for binary searching
+int64_t* quicktime_stsc_totals(quicktime_stsc_t *stsc)
+{
+	long i;
+
+	if(stsc->sample_totals && stsc->totals_entries == stsc->total_entries)
+		return stsc->sample_totals;
+
+	quicktime_stsc_reset_totals(stsc);
+	if(!stsc->total_entries) return 0;
+
+	stsc->sample_totals = malloc(sizeof(int64_t) * stsc->total_entries);
+	stsc->sample_totals[0] = 0;
+	for(i = 1; i < stsc->total_entries; i++)
+	{
+		stsc->sample_totals[i] = stsc->sample_totals[i - 1] +
+			(int64_t)(stsc->table[i].chunk - stsc->table[i - 1].chunk) *
+			stsc->table[i - 1].samples;
+	}
+	stsc->totals_entries = stsc->total_entries;
+	return stsc->sample_totals;
+}
+
+void quicktime_stsc_reset_totals(quicktime_stsc_t *stsc)
+{
+	if(stsc->sample_totals) free(stsc->sample_totals);
+	stsc->sample_totals = 0;
+	stsc->totals_entries = 0;
+}
+
 /* Optimizing while writing doesn't allow seeks during recording so */
 /* entries are created for every chunk and only optimized during */
 /* writeout.  Unfortunately there's no way to keep audio synchronized */
@@ -11,6 +11,8 @@ void quicktime_stsz_init(quicktime_stsz_t *stsz)
 	stsz->total_entries = 0;
 	stsz->entries_allocated = 0;
 	stsz->table = 0;
+	stsz->size_totals = 0;
+	stsz->totals_entries = 0;
 }
 
 void quicktime_stsz_init_video(quicktime_t *file, quicktime_stsz_t *stsz)
@@ -48,6 +50,7 @@ void quicktime_stsz_delete(quicktime_stsz_t *stsz)
 	stsz->table = 0;
 	stsz->total_entries = 0;
 	stsz->entries_allocated = 0;
+	quicktime_stsz_reset_totals(stsz);
 }
 
 void quicktime_stsz_dump(quicktime_stsz_t *stsz)
@@ -151,12 +154,41 @@ void quicktime_update_stsz(quicktime_stsz_t *stsz,
 
 		stsz->table[sample].size = sample_size;
 		if(sample >= stsz->total_entries) stsz->total_entries = sample + 1;
+		quicktime_stsz_reset_totals(stsz);
 	}
 
 //printf("quicktime_update_stsz 5 %d %d\n", sample, sample_size);
 }
 
 
+// Bytes before every sample and after the last one for seeking
+int64_t* quicktime_stsz_totals(quicktime_stsz_t *stsz)
+{
+	long i;
+
+	if(stsz->size_totals && stsz->totals_entries == stsz->total_entries)
+		return stsz->size_totals;
+
+	quicktime_stsz_reset_totals(stsz);
+	if(stsz->sample_size || !stsz->table) return 0;
+
+	stsz->size_totals = malloc(sizeof(int64_t) * (stsz->total_entries + 1));
+	stsz->size_totals[0] = 0;
+	for(i = 0; i < stsz->total_entries; i++)
+	{
+		stsz->size_totals[i + 1] = stsz->size_totals[i] + stsz->table[i].size;
+	}
+	stsz->totals_entries = stsz->total_entries;
+	return stsz->size_totals;
+}
+
+void quicktime_stsz_reset_totals(quicktime_stsz_t *stsz)
+{
+	if(stsz->size_totals) free(stsz->size_totals);
+	stsz->size_totals = 0;
+	stsz->totals_entries = 0;
+}
+
 int quicktime_sample_size(quicktime_trak_t *trak, int sample)
 {
 	quicktime_stsz_t *stsz = &trak->mdia.minf.stbl.stsz;
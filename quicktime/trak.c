@@ -261,35 +261,24 @@ long quicktime_track_samples(quicktime_t *file, quicktime_trak_t *trak)
 
 long quicktime_sample_of_chunk(quicktime_trak_t *trak, long chunk)
 {
-	quicktime_stsc_table_t *table = trak->mdia.minf.stbl.stsc.table;
-	long total_entries = trak->mdia.minf.stbl.stsc.total_entries;
-	long chunk1entry, chunk2entry;
-	long chunk1, chunk2, chunks, total = 0;
-
-	for(chunk1entry = total_entries - 1, chunk2entry = total_entries; 
-		chunk1entry >= 0; 
-		chunk1entry--, chunk2entry--)
-	{
-		chunk1 = table[chunk1entry].chunk;
-
-		if(chunk > chunk1)
-		{
-			if(chunk2entry < total_entries)
-			{
-				chunk2 = table[chunk2entry].chunk;
-
-				if(chunk < chunk2) chunk2 = chunk;
-			}
-			else
-				chunk2 = chunk;
+	quicktime_stsc_t *stsc = &trak->mdia.minf.stbl.stsc;
+	quicktime_stsc_table_t *table = stsc->table;
+	int64_t *totals = quicktime_stsc_totals(stsc);
+	long min = 0, max = stsc->total_entries - 1;
 
-			chunks = chunk2 - chunk1;
+	if(!totals || chunk <= table[0].chunk) return 0;
 
-			total += chunks * table[chunk1entry].samples;
-		}
+/* Last entry starting before the chunk */
+	while(min < max)
+	{
+		long middle = (min + max + 1) / 2;
+		if(table[middle].chunk < chunk)
+			min = middle;
+		else
+			max = middle - 1;
 	}
 
-	return total;
+	return totals[min] + (chunk - table[min].chunk) * table[min].samples;
 }
 
 // For AVI
@@ -315,46 +304,37 @@ int quicktime_chunk_of_sample(int64_t *chunk_sample,
 	quicktime_trak_t *trak, 
 	long sample)
 {
-	quicktime_stsc_table_t *table = trak->mdia.minf.stbl.stsc.table;
-	long total_entries = trak->mdia.minf.stbl.stsc.total_entries;
-	long chunk2entry;
-	long chunk1, chunk2, chunk1samples, range_samples, total = 0;
-
-	chunk1 = 1;
-	chunk1samples = 0;
-	chunk2entry = 0;
+	quicktime_stsc_t *stsc = &trak->mdia.minf.stbl.stsc;
+	quicktime_stsc_table_t *table = stsc->table;
+	int64_t *totals = quicktime_stsc_totals(stsc);
+	long min = 0, max = stsc->total_entries - 1;
+	long chunk1, chunk1samples;
 
-	if(!total_entries)
+	if(!totals || sample < 0)
 	{
 		*chunk_sample = 0;
-		*chunk = 0;
+		*chunk = totals ? 1 : 0;
 		return 0;
 	}
 
-	do
+/* Last entry starting at or before the sample */
+	while(min < max)
 	{
-		chunk2 = table[chunk2entry].chunk;
-		*chunk = chunk2 - chunk1;
-		range_samples = *chunk * chunk1samples;
-
-		if(sample < total + range_samples) break;
-
-		chunk1samples = table[chunk2entry].samples;
-		chunk1 = chunk2;
-
-		if(chunk2entry < total_entries)
-		{
-			chunk2entry++;
-			total += range_samples;
-		}
-	}while(chunk2entry < total_entries);
+		long middle = (min + max + 1) / 2;
+		if(totals[middle] <= sample)
+			min = middle;
+		else
+			max = middle - 1;
+	}
 
+	chunk1 = table[min].chunk;
+	chunk1samples = table[min].samples;
 	if(chunk1samples)
-		*chunk = (sample - total) / chunk1samples + chunk1;
+		*chunk = (sample - totals[min]) / chunk1samples + chunk1;
 	else
 		*chunk = 1;
 
-	*chunk_sample = total + (*chunk - chunk1) * chunk1samples;
+	*chunk_sample = totals[min] + (*chunk - chunk1) * chunk1samples;
 	return 0;
 }
 
@@ -435,6 +415,15 @@ int64_t quicktime_sample_range_size(quicktime_trak_t *trak,
 		/* probably video */
 		else
 		{
+			quicktime_stsz_t *stsz = &trak->mdia.minf.stbl.stsz;
+			int64_t *totals = quicktime_stsz_totals(stsz);
+
+			if(totals && 
+				chunk_sample >= 0 && 
+				chunk_sample <= sample &&
+				sample <= stsz->total_entries)
+				return totals[sample] - totals[chunk_sample];
+
 			for(i = chunk_sample, total = 0; i < sample; i++)
 			{
 				total += trak->mdia.minf.stbl.stsz.table[i].size;
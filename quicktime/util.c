@@ -127,6 +127,89 @@ static int read_preload(quicktime_t *file, char *data, int64_t size)
 	return 0;
 }
 
+/* Range can be read from the buffer or appended to it */
+static int preload_hit(quicktime_t *file, 
+	int64_t start, 
+	int64_t end, 
+	int64_t selection_start, 
+	int64_t selection_end)
+{
+	return (selection_start >= start && 
+			selection_start < end &&
+			selection_end <= end &&
+			selection_end > start) ||
+		(selection_start >= start &&
+			selection_end > end && 
+			selection_end - file->preload_size < end);
+}
+
+/* Swap the read ahead buffers so the one for the range is in the preload_ fields. */
+/* Interleaved tracks far apart in the file each keep a buffer. */
+static void select_preload(quicktime_t *file, 
+	int64_t selection_start, 
+	int64_t selection_end)
+{
+	quicktime_preload_t *window = 0;
+	quicktime_preload_t temp;
+	int i;
+
+	if(preload_hit(file, 
+		file->preload_start, 
+		file->preload_end, 
+		selection_start, 
+		selection_end)) return;
+
+	for(i = 0; i < file->total_preload_windows; i++)
+	{
+		quicktime_preload_t *test = &file->preload_windows[i];
+		if(test->buffer && 
+			preload_hit(file, test->start, test->end, selection_start, selection_end))
+		{
+			window = test;
+			break;
+		}
+	}
+
+/* Replace the oldest buffer */
+	if(!window)
+	{
+		for(i = 0; i < file->total_preload_windows; i++)
+		{
+			quicktime_preload_t *test = &file->preload_windows[i];
+			if(!window || test->age < window->age) window = test;
+		}
+		if(!window) return;
+
+		if(!window->buffer)
+		{
+			window->buffer = calloc(1, file->preload_size);
+			window->start = 0;
+			window->end = 0;
+			window->ptr = 0;
+		}
+	}
+
+	temp = *window;
+	window->buffer = file->preload_buffer;
+	window->start = file->preload_start;
+	window->end = file->preload_end;
+	window->ptr = file->preload_ptr;
+	window->age = ++file->preload_age;
+	file->preload_buffer = temp.buffer;
+	file->preload_start = temp.start;
+	file->preload_end = temp.end;
+	file->preload_ptr = temp.ptr;
+}
+
+/* Have the kernel read the next buffer while this one is used */
+static void read_ahead(quicktime_t *file)
+{
+	posix_fadvise(fileno(file->stream), 
+		file->preload_end, 
+		file->preload_size, 
+		POSIX_FADV_WILLNEED);
+}
+
 int quicktime_read_data(quicktime_t *file, char *data, int64_t size)
 {
 	int result = 1;
@@ -144,11 +227,16 @@ int quicktime_read_data(quicktime_t *file, char *data, int64_t size)
 		int64_t selection_end = file->file_position + size;
 		int64_t fragment_start, fragment_len;
 
+		if(selection_end - selection_start <= file->preload_size)
+			select_preload(file, selection_start, selection_end);
+
 		if(selection_end - selection_start > file->preload_size)
 		{
-/* Size is larger than preload size.  Should never happen. */
-printf("read data Size is larger than preload size. size=%llx preload_size=%llx\n",
-	selection_end - selection_start, file->preload_size);
+/* Size is larger than preload size. */
+/*
+ * printf("read data Size is larger than preload size. size=%llx preload_size=%llx\n",
+ * 	selection_end - selection_start, file->preload_size);
+ */
 			quicktime_fseek(file, file->file_position);
 			result = fread(data, size, 1, file->stream);
 			file->ftell_position += size;
@@ -163,7 +251,8 @@ printf("read data Size is larger than preload size. size=%llx preload_size=%llx\
 			read_preload(file, data, size);
 		}
 		else
-		if(selection_end > file->preload_end && 
+		if(selection_start >= file->preload_start &&
+			selection_end > file->preload_end && 
 			selection_end - file->preload_size < file->preload_end)
 		{
 /* Range is after buffer */
@@ -195,6 +284,7 @@ printf("read data Size is larger than preload size. size=%llx preload_size=%llx\
 				if(fragment_start >= file->preload_size) fragment_start = 0;
 			}
 
+			read_ahead(file);
 			read_preload(file, data, size);
 		}
 		else
@@ -207,6 +297,7 @@ printf("read data Size is larger than preload size. size=%llx preload_size=%llx\
 			file->preload_start = file->file_position;
 			file->preload_end = file->file_position + size;
 			file->preload_ptr = 0;
+			read_ahead(file);
 			read_preload(file, data, size);
 		}
 	}